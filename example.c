@@ -30,8 +30,10 @@ int main(void)
 		return 1;
 	}
 
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
 
 	char *title = "Simple example";
 	GLFWwindow *window = glfwCreateWindow(640, 480, title, NULL, NULL);
@@ -54,6 +56,7 @@ int main(void)
 		int w, h;
 		glfwGetFramebufferSize(window, &w, &h);
 		glViewport(0, 0, w, h);
+		gltSetViewport(0, 0, w, h);
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
@@ -66,13 +69,13 @@ int main(void)
 		gltBindFont(font);
 		gltPushText(&buffer, x, y, text);
 		gltDrawBuffer(&buffer);
+		gltEndFrame();
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
-	free(buffer.vertices);
-	free(buffer.indices);
+	gltBufferFree(&buffer);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	return 0;
@@ -5,10 +5,10 @@
  *
  * Generator: C/C++
  * Specification: gl
- * Extensions: 0
+ * Extensions: 1
  *
  * APIs:
- *  - gl:core=4.3
+ *  - gl:core=4.4
  *
  * Options:
  *  - ALIAS = False
@@ -20,10 +20,10 @@
  *  - ON_DEMAND = False
  *
  * Commandline:
- *    --api='gl:core=4.3' --extensions='' c --header-only --mx --mx-global
+ *    --api='gl:core=4.4' --extensions='GL_ARB_buffer_storage' c --header-only --mx --mx-global
  *
  * Online:
- *    http://glad.sh/#api=gl%3Acore%3D4.3&extensions=&generator=c&options=HEADER_ONLY%2CMX%2CMX_GLOBAL
+ *    http://glad.sh/#api=gl%3Acore%3D4.4&extensions=GL_ARB_buffer_storage&generator=c&options=HEADER_ONLY%2CMX%2CMX_GLOBAL
  *
  */
 
@@ -257,11 +257,13 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_BUFFER_ACCESS_FLAGS 0x911F
 #define GL_BUFFER_BINDING 0x9302
 #define GL_BUFFER_DATA_SIZE 0x9303
+#define GL_BUFFER_IMMUTABLE_STORAGE 0x821F
 #define GL_BUFFER_MAPPED 0x88BC
 #define GL_BUFFER_MAP_LENGTH 0x9120
 #define GL_BUFFER_MAP_OFFSET 0x9121
 #define GL_BUFFER_MAP_POINTER 0x88BD
 #define GL_BUFFER_SIZE 0x8764
+#define GL_BUFFER_STORAGE_FLAGS 0x8220
 #define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
 #define GL_BUFFER_USAGE 0x8765
 #define GL_BUFFER_VARIABLE 0x92E5
@@ -273,6 +275,9 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_CLAMP_TO_EDGE 0x812F
 #define GL_CLEAR 0x1500
 #define GL_CLEAR_BUFFER 0x82B4
+#define GL_CLEAR_TEXTURE 0x9365
+#define GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT 0x00004000
+#define GL_CLIENT_STORAGE_BIT 0x0200
 #define GL_CLIP_DISTANCE0 0x3000
 #define GL_CLIP_DISTANCE1 0x3001
 #define GL_CLIP_DISTANCE2 0x3002
@@ -471,6 +476,7 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_DYNAMIC_COPY 0x88EA
 #define GL_DYNAMIC_DRAW 0x88E8
 #define GL_DYNAMIC_READ 0x88E9
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
 #define GL_ELEMENT_ARRAY_BARRIER_BIT 0x00000002
 #define GL_ELEMENT_ARRAY_BUFFER 0x8893
 #define GL_ELEMENT_ARRAY_BUFFER_BINDING 0x8895
@@ -684,6 +690,7 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_LINE_WIDTH_RANGE 0x0B22
 #define GL_LINK_STATUS 0x8B82
 #define GL_LOCATION 0x930E
+#define GL_LOCATION_COMPONENT 0x934A
 #define GL_LOCATION_INDEX 0x930F
 #define GL_LOGIC_OP_MODE 0x0BF0
 #define GL_LOWER_LEFT 0x8CA1
@@ -691,9 +698,11 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_LOW_INT 0x8DF3
 #define GL_MAJOR_VERSION 0x821B
 #define GL_MANUAL_GENERATE_MIPMAP 0x8294
+#define GL_MAP_COHERENT_BIT 0x0080
 #define GL_MAP_FLUSH_EXPLICIT_BIT 0x0010
 #define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
 #define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#define GL_MAP_PERSISTENT_BIT 0x0040
 #define GL_MAP_READ_BIT 0x0001
 #define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
 #define GL_MAP_WRITE_BIT 0x0002
@@ -829,6 +838,7 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_MAX_VERTEX_ATTRIBS 0x8869
 #define GL_MAX_VERTEX_ATTRIB_BINDINGS 0x82DA
 #define GL_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET 0x82D9
+#define GL_MAX_VERTEX_ATTRIB_STRIDE 0x82E5
 #define GL_MAX_VERTEX_IMAGE_UNIFORMS 0x90CA
 #define GL_MAX_VERTEX_OUTPUT_COMPONENTS 0x9122
 #define GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS 0x90D6
@@ -851,6 +861,7 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_MIN_SAMPLE_SHADING_VALUE 0x8C37
 #define GL_MIPMAP 0x8293
 #define GL_MIRRORED_REPEAT 0x8370
+#define GL_MIRROR_CLAMP_TO_EDGE 0x8743
 #define GL_MULTISAMPLE 0x809D
 #define GL_NAME_LENGTH 0x92F9
 #define GL_NAND 0x150E
@@ -926,6 +937,7 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_PRIMITIVES_GENERATED 0x8C87
 #define GL_PRIMITIVE_RESTART 0x8F9D
 #define GL_PRIMITIVE_RESTART_FIXED_INDEX 0x8D69
+#define GL_PRIMITIVE_RESTART_FOR_PATCHES_SUPPORTED 0x8221
 #define GL_PRIMITIVE_RESTART_INDEX 0x8F9E
 #define GL_PROGRAM 0x82E2
 #define GL_PROGRAM_BINARY_FORMATS 0x87FF
@@ -951,12 +963,16 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_QUADS 0x0007
 #define GL_QUADS_FOLLOW_PROVOKING_VERTEX_CONVENTION 0x8E4C
 #define GL_QUERY 0x82E3
+#define GL_QUERY_BUFFER 0x9192
+#define GL_QUERY_BUFFER_BARRIER_BIT 0x00008000
+#define GL_QUERY_BUFFER_BINDING 0x9193
 #define GL_QUERY_BY_REGION_NO_WAIT 0x8E16
 #define GL_QUERY_BY_REGION_WAIT 0x8E15
 #define GL_QUERY_COUNTER_BITS 0x8864
 #define GL_QUERY_NO_WAIT 0x8E14
 #define GL_QUERY_RESULT 0x8866
 #define GL_QUERY_RESULT_AVAILABLE 0x8867
+#define GL_QUERY_RESULT_NO_WAIT 0x9194
 #define GL_QUERY_WAIT 0x8E13
 #define GL_R11F_G11F_B10F 0x8C3A
 #define GL_R16 0x822A
@@ -1249,6 +1265,7 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_TEXTURE_BLUE_TYPE 0x8C12
 #define GL_TEXTURE_BORDER_COLOR 0x1004
 #define GL_TEXTURE_BUFFER 0x8C2A
+#define GL_TEXTURE_BUFFER_BINDING 0x8C2A
 #define GL_TEXTURE_BUFFER_DATA_STORE_BINDING 0x8C2D
 #define GL_TEXTURE_BUFFER_OFFSET 0x919D
 #define GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT 0x919F
@@ -1326,10 +1343,12 @@ typedef void (*GLADpostcallback)(void *ret, const char *name, GLADapiproc apipro
 #define GL_TRANSFORM_FEEDBACK_BUFFER 0x8C8E
 #define GL_TRANSFORM_FEEDBACK_BUFFER_ACTIVE 0x8E24
 #define GL_TRANSFORM_FEEDBACK_BUFFER_BINDING 0x8C8F
+#define GL_TRANSFORM_FEEDBACK_BUFFER_INDEX 0x934B
 #define GL_TRANSFORM_FEEDBACK_BUFFER_MODE 0x8C7F
 #define GL_TRANSFORM_FEEDBACK_BUFFER_PAUSED 0x8E23
 #define GL_TRANSFORM_FEEDBACK_BUFFER_SIZE 0x8C85
 #define GL_TRANSFORM_FEEDBACK_BUFFER_START 0x8C84
+#define GL_TRANSFORM_FEEDBACK_BUFFER_STRIDE 0x934C
 #define GL_TRANSFORM_FEEDBACK_PAUSED 0x8E23
 #define GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN 0x8C88
 #define GL_TRANSFORM_FEEDBACK_VARYING 0x92F4
@@ -1876,6 +1895,8 @@ typedef void (GLAD_API_PTR *GLVULKANPROCNV)(void);
 #define GL_VERSION_4_1 1
 #define GL_VERSION_4_2 1
 #define GL_VERSION_4_3 1
+#define GL_VERSION_4_4 1
+#define GL_ARB_buffer_storage 1
 
 
 typedef void (GLAD_API_PTR *PFNGLACTIVESHADERPROGRAMPROC)(GLuint pipeline, GLuint program);
@@ -1889,17 +1910,23 @@ typedef void (GLAD_API_PTR *PFNGLBINDATTRIBLOCATIONPROC)(GLuint program, GLuint
 typedef void (GLAD_API_PTR *PFNGLBINDBUFFERPROC)(GLenum target, GLuint buffer);
 typedef void (GLAD_API_PTR *PFNGLBINDBUFFERBASEPROC)(GLenum target, GLuint index, GLuint buffer);
 typedef void (GLAD_API_PTR *PFNGLBINDBUFFERRANGEPROC)(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+typedef void (GLAD_API_PTR *PFNGLBINDBUFFERSBASEPROC)(GLenum target, GLuint first, GLsizei count, const GLuint * buffers);
+typedef void (GLAD_API_PTR *PFNGLBINDBUFFERSRANGEPROC)(GLenum target, GLuint first, GLsizei count, const GLuint * buffers, const GLintptr * offsets, const GLsizeiptr * sizes);
 typedef void (GLAD_API_PTR *PFNGLBINDFRAGDATALOCATIONPROC)(GLuint program, GLuint color, const GLchar * name);
 typedef void (GLAD_API_PTR *PFNGLBINDFRAGDATALOCATIONINDEXEDPROC)(GLuint program, GLuint colorNumber, GLuint index, const GLchar * name);
 typedef void (GLAD_API_PTR *PFNGLBINDFRAMEBUFFERPROC)(GLenum target, GLuint framebuffer);
 typedef void (GLAD_API_PTR *PFNGLBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (GLAD_API_PTR *PFNGLBINDIMAGETEXTURESPROC)(GLuint first, GLsizei count, const GLuint * textures);
 typedef void (GLAD_API_PTR *PFNGLBINDPROGRAMPIPELINEPROC)(GLuint pipeline);
 typedef void (GLAD_API_PTR *PFNGLBINDRENDERBUFFERPROC)(GLenum target, GLuint renderbuffer);
 typedef void (GLAD_API_PTR *PFNGLBINDSAMPLERPROC)(GLuint unit, GLuint sampler);
+typedef void (GLAD_API_PTR *PFNGLBINDSAMPLERSPROC)(GLuint first, GLsizei count, const GLuint * samplers);
 typedef void (GLAD_API_PTR *PFNGLBINDTEXTUREPROC)(GLenum target, GLuint texture);
+typedef void (GLAD_API_PTR *PFNGLBINDTEXTURESPROC)(GLuint first, GLsizei count, const GLuint * textures);
 typedef void (GLAD_API_PTR *PFNGLBINDTRANSFORMFEEDBACKPROC)(GLenum target, GLuint id);
 typedef void (GLAD_API_PTR *PFNGLBINDVERTEXARRAYPROC)(GLuint array);
 typedef void (GLAD_API_PTR *PFNGLBINDVERTEXBUFFERPROC)(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+typedef void (GLAD_API_PTR *PFNGLBINDVERTEXBUFFERSPROC)(GLuint first, GLsizei count, const GLuint * buffers, const GLintptr * offsets, const GLsizei * strides);
 typedef void (GLAD_API_PTR *PFNGLBLENDCOLORPROC)(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
 typedef void (GLAD_API_PTR *PFNGLBLENDEQUATIONPROC)(GLenum mode);
 typedef void (GLAD_API_PTR *PFNGLBLENDEQUATIONSEPARATEPROC)(GLenum modeRGB, GLenum modeAlpha);
@@ -1911,6 +1938,7 @@ typedef void (GLAD_API_PTR *PFNGLBLENDFUNCSEPARATEIPROC)(GLuint buf, GLenum srcR
 typedef void (GLAD_API_PTR *PFNGLBLENDFUNCIPROC)(GLuint buf, GLenum src, GLenum dst);
 typedef void (GLAD_API_PTR *PFNGLBLITFRAMEBUFFERPROC)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
 typedef void (GLAD_API_PTR *PFNGLBUFFERDATAPROC)(GLenum target, GLsizeiptr size, const void * data, GLenum usage);
+typedef void (GLAD_API_PTR *PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void * data, GLbitfield flags);
 typedef void (GLAD_API_PTR *PFNGLBUFFERSUBDATAPROC)(GLenum target, GLintptr offset, GLsizeiptr size, const void * data);
 typedef GLenum (GLAD_API_PTR *PFNGLCHECKFRAMEBUFFERSTATUSPROC)(GLenum target);
 typedef void (GLAD_API_PTR *PFNGLCLAMPCOLORPROC)(GLenum target, GLenum clamp);
@@ -1925,6 +1953,8 @@ typedef void (GLAD_API_PTR *PFNGLCLEARCOLORPROC)(GLfloat red, GLfloat green, GLf
 typedef void (GLAD_API_PTR *PFNGLCLEARDEPTHPROC)(GLdouble depth);
 typedef void (GLAD_API_PTR *PFNGLCLEARDEPTHFPROC)(GLfloat d);
 typedef void (GLAD_API_PTR *PFNGLCLEARSTENCILPROC)(GLint s);
+typedef void (GLAD_API_PTR *PFNGLCLEARTEXIMAGEPROC)(GLuint texture, GLint level, GLenum format, GLenum type, const void * data);
+typedef void (GLAD_API_PTR *PFNGLCLEARTEXSUBIMAGEPROC)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void * data);
 typedef GLenum (GLAD_API_PTR *PFNGLCLIENTWAITSYNCPROC)(GLsync sync, GLbitfield flags, GLuint64 timeout);
 typedef void (GLAD_API_PTR *PFNGLCOLORMASKPROC)(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
 typedef void (GLAD_API_PTR *PFNGLCOLORMASKIPROC)(GLuint index, GLboolean r, GLboolean g, GLboolean b, GLboolean a);
@@ -2432,6 +2462,8 @@ typedef struct GladGLContext {
     int VERSION_4_1;
     int VERSION_4_2;
     int VERSION_4_3;
+    int VERSION_4_4;
+    int ARB_buffer_storage;
 
     PFNGLACTIVESHADERPROGRAMPROC ActiveShaderProgram;
     PFNGLACTIVETEXTUREPROC ActiveTexture;
@@ -2444,17 +2476,23 @@ typedef struct GladGLContext {
     PFNGLBINDBUFFERPROC BindBuffer;
     PFNGLBINDBUFFERBASEPROC BindBufferBase;
     PFNGLBINDBUFFERRANGEPROC BindBufferRange;
+    PFNGLBINDBUFFERSBASEPROC BindBuffersBase;
+    PFNGLBINDBUFFERSRANGEPROC BindBuffersRange;
     PFNGLBINDFRAGDATALOCATIONPROC BindFragDataLocation;
     PFNGLBINDFRAGDATALOCATIONINDEXEDPROC BindFragDataLocationIndexed;
     PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
     PFNGLBINDIMAGETEXTUREPROC BindImageTexture;
+    PFNGLBINDIMAGETEXTURESPROC BindImageTextures;
     PFNGLBINDPROGRAMPIPELINEPROC BindProgramPipeline;
     PFNGLBINDRENDERBUFFERPROC BindRenderbuffer;
     PFNGLBINDSAMPLERPROC BindSampler;
+    PFNGLBINDSAMPLERSPROC BindSamplers;
     PFNGLBINDTEXTUREPROC BindTexture;
+    PFNGLBINDTEXTURESPROC BindTextures;
     PFNGLBINDTRANSFORMFEEDBACKPROC BindTransformFeedback;
     PFNGLBINDVERTEXARRAYPROC BindVertexArray;
     PFNGLBINDVERTEXBUFFERPROC BindVertexBuffer;
+    PFNGLBINDVERTEXBUFFERSPROC BindVertexBuffers;
     PFNGLBLENDCOLORPROC BlendColor;
     PFNGLBLENDEQUATIONPROC BlendEquation;
     PFNGLBLENDEQUATIONSEPARATEPROC BlendEquationSeparate;
@@ -2466,6 +2504,7 @@ typedef struct GladGLContext {
     PFNGLBLENDFUNCIPROC BlendFunci;
     PFNGLBLITFRAMEBUFFERPROC BlitFramebuffer;
     PFNGLBUFFERDATAPROC BufferData;
+    PFNGLBUFFERSTORAGEPROC BufferStorage;
     PFNGLBUFFERSUBDATAPROC BufferSubData;
     PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
     PFNGLCLAMPCOLORPROC ClampColor;
@@ -2480,6 +2519,8 @@ typedef struct GladGLContext {
     PFNGLCLEARDEPTHPROC ClearDepth;
     PFNGLCLEARDEPTHFPROC ClearDepthf;
     PFNGLCLEARSTENCILPROC ClearStencil;
+    PFNGLCLEARTEXIMAGEPROC ClearTexImage;
+    PFNGLCLEARTEXSUBIMAGEPROC ClearTexSubImage;
     PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
     PFNGLCOLORMASKPROC ColorMask;
     PFNGLCOLORMASKIPROC ColorMaski;
@@ -2988,6 +3029,8 @@ GLAD_API_CALL GladGLContext* glad_gl_context;
 #define GLAD_GL_VERSION_4_1 (glad_gl_context->VERSION_4_1)
 #define GLAD_GL_VERSION_4_2 (glad_gl_context->VERSION_4_2)
 #define GLAD_GL_VERSION_4_3 (glad_gl_context->VERSION_4_3)
+#define GLAD_GL_VERSION_4_4 (glad_gl_context->VERSION_4_4)
+#define GLAD_GL_ARB_buffer_storage (glad_gl_context->ARB_buffer_storage)
 
 #define glActiveShaderProgram (glad_gl_context->ActiveShaderProgram)
 #define glActiveTexture (glad_gl_context->ActiveTexture)
@@ -3000,17 +3043,23 @@ GLAD_API_CALL GladGLContext* glad_gl_context;
 #define glBindBuffer (glad_gl_context->BindBuffer)
 #define glBindBufferBase (glad_gl_context->BindBufferBase)
 #define glBindBufferRange (glad_gl_context->BindBufferRange)
+#define glBindBuffersBase (glad_gl_context->BindBuffersBase)
+#define glBindBuffersRange (glad_gl_context->BindBuffersRange)
 #define glBindFragDataLocation (glad_gl_context->BindFragDataLocation)
 #define glBindFragDataLocationIndexed (glad_gl_context->BindFragDataLocationIndexed)
 #define glBindFramebuffer (glad_gl_context->BindFramebuffer)
 #define glBindImageTexture (glad_gl_context->BindImageTexture)
+#define glBindImageTextures (glad_gl_context->BindImageTextures)
 #define glBindProgramPipeline (glad_gl_context->BindProgramPipeline)
 #define glBindRenderbuffer (glad_gl_context->BindRenderbuffer)
 #define glBindSampler (glad_gl_context->BindSampler)
+#define glBindSamplers (glad_gl_context->BindSamplers)
 #define glBindTexture (glad_gl_context->BindTexture)
+#define glBindTextures (glad_gl_context->BindTextures)
 #define glBindTransformFeedback (glad_gl_context->BindTransformFeedback)
 #define glBindVertexArray (glad_gl_context->BindVertexArray)
 #define glBindVertexBuffer (glad_gl_context->BindVertexBuffer)
+#define glBindVertexBuffers (glad_gl_context->BindVertexBuffers)
 #define glBlendColor (glad_gl_context->BlendColor)
 #define glBlendEquation (glad_gl_context->BlendEquation)
 #define glBlendEquationSeparate (glad_gl_context->BlendEquationSeparate)
@@ -3022,6 +3071,7 @@ GLAD_API_CALL GladGLContext* glad_gl_context;
 #define glBlendFunci (glad_gl_context->BlendFunci)
 #define glBlitFramebuffer (glad_gl_context->BlitFramebuffer)
 #define glBufferData (glad_gl_context->BufferData)
+#define glBufferStorage (glad_gl_context->BufferStorage)
 #define glBufferSubData (glad_gl_context->BufferSubData)
 #define glCheckFramebufferStatus (glad_gl_context->CheckFramebufferStatus)
 #define glClampColor (glad_gl_context->ClampColor)
@@ -3036,6 +3086,8 @@ GLAD_API_CALL GladGLContext* glad_gl_context;
 #define glClearDepth (glad_gl_context->ClearDepth)
 #define glClearDepthf (glad_gl_context->ClearDepthf)
 #define glClearStencil (glad_gl_context->ClearStencil)
+#define glClearTexImage (glad_gl_context->ClearTexImage)
+#define glClearTexSubImage (glad_gl_context->ClearTexSubImage)
 #define glClientWaitSync (glad_gl_context->ClientWaitSync)
 #define glColorMask (glad_gl_context->ColorMask)
 #define glColorMaski (glad_gl_context->ColorMaski)
@@ -4165,6 +4217,22 @@ static void glad_gl_load_GL_VERSION_4_3(GladGLContext *context, GLADuserptrloadf
     context->VertexAttribLFormat = (PFNGLVERTEXATTRIBLFORMATPROC) load(userptr, "glVertexAttribLFormat");
     context->VertexBindingDivisor = (PFNGLVERTEXBINDINGDIVISORPROC) load(userptr, "glVertexBindingDivisor");
 }
+static void glad_gl_load_GL_VERSION_4_4(GladGLContext *context, GLADuserptrloadfunc load, void* userptr) {
+    if(!context->VERSION_4_4) return;
+    context->BindBuffersBase = (PFNGLBINDBUFFERSBASEPROC) load(userptr, "glBindBuffersBase");
+    context->BindBuffersRange = (PFNGLBINDBUFFERSRANGEPROC) load(userptr, "glBindBuffersRange");
+    context->BindImageTextures = (PFNGLBINDIMAGETEXTURESPROC) load(userptr, "glBindImageTextures");
+    context->BindSamplers = (PFNGLBINDSAMPLERSPROC) load(userptr, "glBindSamplers");
+    context->BindTextures = (PFNGLBINDTEXTURESPROC) load(userptr, "glBindTextures");
+    context->BindVertexBuffers = (PFNGLBINDVERTEXBUFFERSPROC) load(userptr, "glBindVertexBuffers");
+    context->BufferStorage = (PFNGLBUFFERSTORAGEPROC) load(userptr, "glBufferStorage");
+    context->ClearTexImage = (PFNGLCLEARTEXIMAGEPROC) load(userptr, "glClearTexImage");
+    context->ClearTexSubImage = (PFNGLCLEARTEXSUBIMAGEPROC) load(userptr, "glClearTexSubImage");
+}
+static void glad_gl_load_GL_ARB_buffer_storage(GladGLContext *context, GLADuserptrloadfunc load, void* userptr) {
+    if(!context->ARB_buffer_storage) return;
+    context->BufferStorage = (PFNGLBUFFERSTORAGEPROC) load(userptr, "glBufferStorage");
+}
 
 
 
@@ -4272,7 +4340,7 @@ static int glad_gl_find_extensions_gl(GladGLContext *context, int version) {
     char **exts_i = NULL;
     if (!glad_gl_get_extensions(context, version, &exts, &num_exts_i, &exts_i)) return 0;
 
-    GLAD_UNUSED(glad_gl_has_extension);
+    context->ARB_buffer_storage = glad_gl_has_extension(version, exts, num_exts_i, exts_i, "GL_ARB_buffer_storage");
 
     glad_gl_free_extensions(exts_i, num_exts_i);
 
@@ -4319,6 +4387,7 @@ static int glad_gl_find_core_gl(GladGLContext *context) {
     context->VERSION_4_1 = (major == 4 && minor >= 1) || major > 4;
     context->VERSION_4_2 = (major == 4 && minor >= 2) || major > 4;
     context->VERSION_4_3 = (major == 4 && minor >= 3) || major > 4;
+    context->VERSION_4_4 = (major == 4 && minor >= 4) || major > 4;
 
     return GLAD_MAKE_VERSION(major, minor);
 }
@@ -4347,8 +4416,10 @@ int gladLoadGLContextUserPtr(GladGLContext *context, GLADuserptrloadfunc load, v
     glad_gl_load_GL_VERSION_4_1(context, load, userptr);
     glad_gl_load_GL_VERSION_4_2(context, load, userptr);
     glad_gl_load_GL_VERSION_4_3(context, load, userptr);
+    glad_gl_load_GL_VERSION_4_4(context, load, userptr);
 
     if (!glad_gl_find_extensions_gl(context, version)) return 0;
+    glad_gl_load_GL_ARB_buffer_storage(context, load, userptr);
 
     gladSetGLContext(context);
 
@@ -16,24 +16,114 @@ typedef struct {
 	float advance;
 } GLTglyph;
 
+/*
+ * All fonts share a single texture atlas, so text in different fonts can be
+ * drawn with a single draw call. Each font has its own table of 128 glyphs,
+ * which is allocated and filled the first time the font is used.
+ */
 typedef struct {
 	float currentOffsetX;
 	float currentOffsetY;
 	float currentRowHeight;
 	GLuint textureAtlas;
-	GLTglyph glyphs[256];
+	GLTglyph *glyphs[256];
+
+	/* Copy of the atlas in memory for the software rasterizer or NULL */
+	unsigned char *pixels;
+
+	/* Vertical extent of all glyphs of a font relative to the baseline */
+	float ascent[256];
+	float descent[256];
+
+	/* Smallest horizontal bearing of all glyphs of a font, at most zero */
+	float minBearingX[256];
 } GLTcache;
 
+/*
+ * An allocator resizes the block at ptr from oldSize to newSize bytes, just
+ * like realloc. A newSize of zero frees the block and returns NULL.
+ */
+typedef struct {
+	void *(*realloc)(void *user, void *ptr, GLsizeiptr oldSize, GLsizeiptr newSize);
+	void *user;
+} GLTallocator;
+
+/*
+ * The color is multiplied with the color set by gltSetColorRGBA, so white
+ * vertices keep the behavior of the uniform color.
+ */
+typedef struct {
+	GLfloat x, y;
+	GLfloat u, v;
+	GLubyte color[4];
+} GLTvertex;
+
+/*
+ * The vertices and indices share a single allocation with room for
+ * maxGlyphCount quads: all vertices first, followed by all indices. The
+ * allocation is made with the allocator of the buffer or with GLT_REALLOC if
+ * it is NULL.
+ */
 typedef struct {
-	GLfloat *vertices;
-	GLsizei maxVertexCount;
+	GLTvertex *vertices;
 	GLsizei vertexCount;
 
 	GLuint *indices;
-	GLsizei maxIndexCount;
 	GLsizei indexCount;
+
+	GLsizei maxGlyphCount;
+	GLsizei highWaterMark;
+	GLTallocator *allocator;
+
+	GLboolean hasClip;
+	float clipMinX, clipMinY;
+	float clipMaxX, clipMaxY;
 } GLTbuffer;
 
+/*
+ * An item for gltPushTextBatch. A negative length means that the text is
+ * null-terminated. The color is a packed color created with GLT_RGBA or zero
+ * to use the current vertex color.
+ */
+typedef struct {
+	char *text;
+	GLsizei length;
+	float x, y;
+	GLuint color;
+} GLTtextItem;
+
+#define GLT_RGBA(r, g, b, a) (((GLuint)(r) << 24) | ((GLuint)(g) << 16) \
+	| ((GLuint)(b) << 8) | (GLuint)(a))
+
+/*
+ * Retained text keeps a copy of its characters, the pen position of every
+ * character and its geometry with exactly one quad per character, so that
+ * edits can rewrite only the affected quads. The version counts the edits
+ * and the bounds enclose all quads, which are only computed again when the
+ * text is drawn or tracked after an edit. Both are compared with what was
+ * drawn last to find the damaged parts of the window.
+ */
+typedef struct {
+	GLuint vertexArray;
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	GLsizei indexCount;
+	GLsizei maxGlyphCount;
+
+	char *text;
+	float *offsets;
+	GLsizei length;
+	GLsizei maxLength;
+	GLTbuffer geometry;
+
+	unsigned long long style;
+	unsigned long long version;
+	float bounds[4];
+	GLboolean hasBounds;
+	unsigned long long drawnKey;
+	GLint drawnRect[4];
+} GLTtext;
+
 /*
  * Either use gltPushText and gltDraw or gltDrawText. gltDrawText just calls
  * gltPushText and gltDraw with a new buffer on every call. Hence, for batching
@@ -41,13 +131,414 @@ typedef struct {
  *
  * gltDraw resets the state of the buffer, i.e. setting vertexCount and
  * indexCount back to zero.
+ *
+ * gltPushText returns the horizontal position after the last glyph, so that
+ * differently colored spans of a line can be pushed one after another.
  */
-GLT_API void gltPushText(GLTbuffer *b, float x, float y, char *text);
-GLT_API void gltPushnText(GLTbuffer *b, float x, float y, char *text, GLsizei count);
+GLT_API float gltPushText(GLTbuffer *b, float x, float y, char *text);
+GLT_API float gltPushnText(GLTbuffer *b, float x, float y, char *text, GLsizei count);
 GLT_API void gltDrawText(float x, float y, char *text);
 GLT_API void gltDrawnText(float x, float y, char *text, GLsizei count);
 GLT_API void gltDrawBuffer(GLTbuffer *b);
 
+/*
+ * Pushes many strings at once, like a call to gltPushnText for every item,
+ * but updates the cache only once and reserves space for all items with a
+ * known length at once. Null-terminated strings are measured only once.
+ */
+GLT_API void gltPushTextBatch(GLTbuffer *b, const GLTtextItem *items, GLsizei count);
+
+/*
+ * An item for gltDrawBuffers. The offset is added to the positions of the
+ * buffer. The color is a packed color created with GLT_RGBA or zero to use the
+ * current color. The transform is a column-major matrix or NULL to use the
+ * current transform.
+ */
+typedef struct {
+	GLTbuffer *buffer;
+	float x, y;
+	GLuint color;
+	float *transform;
+} GLTdrawItem;
+
+/*
+ * Draws many buffers at once, like a call to gltDrawBuffer for every item. The
+ * buffers are packed into the stream ring and drawn with a single
+ * glMultiDrawElementsIndirect call for every GLT_BATCH_SIZE buffers, reading
+ * the color and transform of each item from a uniform buffer. Without OpenGL
+ * 4.3, the buffers are drawn one after another from the same ring region.
+ *
+ * This changes the uniform buffer bound to binding point zero and the draw
+ * indirect buffer.
+ */
+GLT_API void gltDrawBuffers(const GLTdrawItem *items, GLsizei count);
+
+typedef struct {
+	GLfloat outlineColor[4];
+	GLfloat outlineWidth;
+	GLfloat shadowColor[4];
+	GLfloat shadowOffset[2];
+} GLTeffect;
+
+typedef struct {
+	int layer;
+	GLuint atlas;
+	GLsizei transform;
+	GLsizei effect;
+	GLsizei first;
+	GLsizei count;
+} GLTlistCommand;
+
+/*
+ * A draw list records pushed text with the current font, color, transform,
+ * effect and layer instead of drawing it immediately. The glyphs are clipped
+ * by the clip rectangle of the geometry buffer when they are pushed. The
+ * allocator is used for the commands, transforms and effects, the allocator of
+ * the geometry for glyphs.
+ */
+typedef struct {
+	GLTbuffer geometry;
+	GLTbuffer run;
+	GLTallocator *allocator;
+	GLTlistCommand *commands;
+	GLsizei commandCount;
+	GLsizei maxCommandCount;
+	float *transforms;
+	GLsizei transformCount;
+	GLsizei maxTransformCount;
+	GLTeffect *effects;
+	GLsizei effectCount;
+	GLsizei maxEffectCount;
+	int layer;
+} GLTlist;
+
+/*
+ * gltListLayer sets the layer of the following pushes. gltDrawList sorts the
+ * commands by layer, atlas, transform and effect, keeping the order of pushes
+ * with equal keys, and draws each run of commands which share all of them
+ * with one submission. Colors are stored in the vertices, so they
+ * never split a run. Text in a lower layer is drawn below text in a higher
+ * layer. Afterwards, the list is empty.
+ */
+GLT_API void gltListLayer(GLTlist *l, int layer);
+GLT_API float gltListPushText(GLTlist *l, float x, float y, char *text);
+GLT_API float gltListPushnText(GLTlist *l, float x, float y, char *text, GLsizei count);
+GLT_API void gltDrawList(GLTlist *l);
+GLT_API void gltListFree(GLTlist *l);
+
+/*
+ * A label vertex is pinned to an anchor in the world and moved by an offset
+ * in pixels of the font, which the vertex shader applies facing the camera.
+ */
+typedef struct {
+	GLfloat anchor[3];
+	GLfloat x, y;
+	GLfloat u, v;
+	GLubyte color[4];
+} GLTlabelVertex;
+
+/* The indices of the quads are generated when the labels are drawn */
+typedef struct {
+	GLTlabelVertex *vertices;
+	GLsizei vertexCount;
+	GLsizei maxGlyphCount;
+	GLTallocator *allocator;
+} GLTlabels;
+
+/*
+ * Labels pin text to points of a 3D scene and are all drawn with a single
+ * draw call. gltPushLabel places the origin of the text (offsetX, offsetY)
+ * pixels away from the anchor (x, y, z) and returns the offset after the text.
+ *
+ * gltSetLabelCamera sets the column-major view and projection matrices. With
+ * a scale of zero, which is the default, labels keep their size in pixels on
+ * the screen. Otherwise they are billboards in the world, where a pixel of
+ * the font is scale units large, so they shrink with distance. gltDrawLabels
+ * draws the labels with the current color and resets them.
+ */
+GLT_API float gltPushLabel(GLTlabels *l, float x, float y, float z,
+	float offsetX, float offsetY, char *text);
+GLT_API float gltPushnLabel(GLTlabels *l, float x, float y, float z,
+	float offsetX, float offsetY, char *text, GLsizei count);
+GLT_API void gltSetLabelCamera(float *view, float *projection);
+GLT_API void gltSetLabelScale(float scale);
+GLT_API void gltDrawLabels(GLTlabels *l);
+GLT_API void gltLabelsFree(GLTlabels *l);
+
+/*
+ * Selects where the texture atlas is stored, must be called before any text
+ * is pushed. The default is GLT_ATLAS_GPU. The software rasterizer needs
+ * GLT_ATLAS_CPU. With only GLT_ATLAS_CPU, pushing text makes no OpenGL calls,
+ * so it works without a context.
+ */
+#define GLT_ATLAS_GPU (1 << 0)
+#define GLT_ATLAS_CPU (1 << 1)
+GLT_API void gltSetAtlasStorage(GLbitfield storage);
+
+/* An image in memory with one (red) or four (RGBA) channels per pixel */
+typedef struct {
+	unsigned char *pixels;
+	int width;
+	int height;
+	int stride;
+	int channels;
+} GLTimage;
+
+/*
+ * The software rasterizer draws the quads of a buffer into an image, blending
+ * them like gltDrawBuffer with the current color. Positions are pixels of the
+ * image with the origin in its lower left corner, while the rows of the image
+ * are stored from top to bottom. Transforms are ignored. Glyphs are sampled at
+ * the nearest texel, which matches gltDrawBuffer exactly for text at whole
+ * pixel positions.
+ *
+ * gltRasterizeTile only draws into the given rectangle and does not change
+ * the buffer, so non-overlapping tiles can be drawn from several threads at
+ * once. gltRasterizeBuffer draws the whole image and resets the buffer.
+ */
+GLT_API void gltRasterizeTile(const GLTbuffer *b, GLTimage *image,
+	int x, int y, int width, int height);
+GLT_API void gltRasterizeBuffer(GLTbuffer *b, GLTimage *image);
+
+/* The state of a draw, the transform is a column-major matrix */
+typedef struct {
+	GLfloat transform[16];
+	GLfloat offset[2];
+	GLfloat color[4];
+	GLuint texture;
+	GLTeffect effect;
+} GLTdrawState;
+
+/* The state of a label draw, the viewport is the size in pixels */
+typedef struct {
+	GLfloat view[16];
+	GLfloat projection[16];
+	GLfloat viewport[2];
+	GLfloat scale;
+	GLfloat color[4];
+	GLuint texture;
+	GLTeffect effect;
+} GLTlabelState;
+
+/*
+ * A backend receives all work for the GPU. The library does the layout and
+ * builds the vertices, the backend creates and updates the atlas texture,
+ * uploads and draws the geometry and manages its own state. drawBuffers uses
+ * the state for items without their own color or transform. useProgram
+ * prepares the state for draws of the caller. The GL fields of retained text
+ * belong to the backend. All members up to endFrame are required, drawLabels
+ * and useProgram may be NULL, in which case labels are not drawn and
+ * gltUseProgram does nothing.
+ */
+typedef struct {
+	void *user;
+	GLuint (*createTexture)(void *user, GLsizei width, GLsizei height);
+	void (*updateTexture)(void *user, GLuint texture, GLint x, GLint y,
+		GLsizei width, GLsizei height, GLsizei stride, const unsigned char *pixels);
+	void (*getViewport)(void *user, GLint *viewport);
+	void (*drawBuffer)(void *user, GLTbuffer *b, const GLTdrawState *state);
+	void (*drawBuffers)(void *user, const GLTdrawItem *items, GLsizei count,
+		const GLTdrawState *state);
+	void (*uploadText)(void *user, GLTtext *t, GLsizei first, GLsizei last);
+	void (*drawText)(void *user, GLTtext *t, const GLTdrawState *state);
+	void (*deleteText)(void *user, GLTtext *t);
+	void (*endFrame)(void *user);
+	void (*drawLabels)(void *user, GLTlabels *l, const GLTlabelState *state);
+	void (*useProgram)(void *user, const GLTdrawState *state);
+} GLTbackend;
+
+/*
+ * Selects the backend, NULL selects the OpenGL backend, which is the default.
+ * The null backend makes no OpenGL calls and only counts the work it receives,
+ * which separates the cost of the library from the cost of the driver. A new
+ * backend gets a new atlas texture, which is filled from the copy in memory
+ * if there is one. Otherwise, the glyphs are rasterized again and text pushed
+ * before the change has to be pushed again.
+ */
+GLT_API void gltSetBackend(GLTbackend *backend);
+GLT_API GLTbackend *gltGLBackend(void);
+GLT_API GLTbackend *gltNullBackend(void);
+
+typedef struct {
+	unsigned long long textureCount;
+	unsigned long long texelCount;
+	unsigned long long drawCount;
+	unsigned long long glyphCount;
+	unsigned long long uploadCount;
+	unsigned long long frameCount;
+} GLTnullStats;
+
+/* Returns the work which the null backend received since the program started */
+GLT_API void gltGetNullStats(GLTnullStats *stats);
+
+/*
+ * gltBufferReserve makes room for at least glyphCount glyphs in total and
+ * returns GL_FALSE if the allocation failed. gltBufferShrink releases all
+ * memory not used by the current contents and gltBufferFree releases the
+ * buffer entirely.
+ *
+ * If GLT_BUFFER_DECAY is defined to N > 0, gltDrawBuffer keeps a high-water
+ * mark of the glyph count that decays by 1/N, but at least by one glyph, every
+ * draw and shrinks the buffer once it is more than twice as large as the
+ * high-water mark.
+ */
+GLT_API GLboolean gltBufferReserve(GLTbuffer *b, GLsizei glyphCount);
+GLT_API void gltBufferShrink(GLTbuffer *b);
+GLT_API void gltBufferFree(GLTbuffer *b);
+
+/*
+ * Sets the clip rectangle for all following pushes into the buffer. Runs of
+ * text that lie completely above or below the rectangle are rejected without
+ * looking at their glyphs, in which case gltPushText returns x unchanged.
+ * Glyphs outside of the rectangle are skipped and glyphs on its border are
+ * trimmed to it. A run stops at the first glyph past the right edge, so
+ * gltPushText then returns the position of that glyph instead of the end of
+ * the text.
+ */
+GLT_API void gltBufferClip(GLTbuffer *b, float x, float y, float width, float height);
+GLT_API void gltBufferNoClip(GLTbuffer *b);
+
+/*
+ * Memory from the frame allocator stays valid until the next call to
+ * gltEndFrame, which frees all of it at once. gltDrawText uses it for its
+ * temporary buffers, so drawing text does not allocate any memory once the
+ * allocator has grown to the size needed per frame.
+ */
+GLT_API GLTallocator *gltFrameAllocator(void);
+GLT_API void gltEndFrame(void);
+
+/*
+ * All text is drawn from a ring buffer of GLT_STREAM_SIZE bytes, into which
+ * every frame appends its geometry. gltEndFrame places a fence behind the
+ * geometry of the frame and the ring only waits for the GPU when it runs into
+ * geometry of a frame whose fence has not signaled yet. At most
+ * GLT_STREAM_FRAMES frames can be in flight.
+ *
+ * If the driver supports GL_ARB_buffer_storage, the ring is persistently
+ * mapped. Buffers using the stream allocator are then stored in the ring
+ * itself, so pushes write directly into GPU memory and gltDrawBuffer does not
+ * copy the geometry. After drawing, such a buffer moves on to a fresh region
+ * of the ring. All other buffers are copied into the ring when they are drawn.
+ */
+GLT_API GLTallocator *gltStreamAllocator(void);
+
+typedef struct {
+	unsigned long long frameCount;
+	unsigned long long fenceCount;
+	unsigned long long waitCount;
+	unsigned long long bytesCopied;
+} GLTstreamStats;
+
+/*
+ * Returns how often the ring had to wait for the GPU and how much geometry had
+ * to be copied into it since the program started.
+ */
+GLT_API void gltGetStreamStats(GLTstreamStats *stats);
+
+/* The time the GPU spent on text in a frame, in nanoseconds */
+typedef struct {
+	unsigned long long frame;
+	unsigned long long uploadTime;
+	unsigned long long drawTime;
+} GLTgpuTime;
+
+/*
+ * With GPU timing enabled, the OpenGL backend measures atlas uploads and draws
+ * with GL_TIME_ELAPSED queries. The results of a frame are read back
+ * GLT_TIMING_FRAMES - 1 frames later and only if they have arrived, so the
+ * queries never stall. gltGetGPUTime returns the times of the latest frame
+ * that was read back, or GL_FALSE if there is none yet. Frames are counted by
+ * gltEndFrame, starting at zero.
+ */
+GLT_API void gltSetGPUTiming(GLboolean isEnabled);
+GLT_API GLboolean gltGetGPUTime(GLTgpuTime *time);
+
+/* Counters of the work done on the CPU, the times are in nanoseconds */
+typedef struct {
+	unsigned long long glyphCount;
+	unsigned long long quadCount;
+	unsigned long long skippedQuadCount;
+	unsigned long long cacheHitCount;
+	unsigned long long cacheMissCount;
+	unsigned long long rasterizedCount;
+	unsigned long long uploadedBytes;
+	unsigned long long reallocCount;
+	unsigned long long allocatedBytes;
+	unsigned long long drawCount;
+	unsigned long long vertexBytes;
+	unsigned long long freetypeTime;
+} GLTcounters;
+
+typedef struct {
+	GLTcounters frame;
+	GLTcounters total;
+} GLTstats;
+
+/*
+ * Returns the counters of the last frame ended by gltEndFrame and the totals
+ * since the start or gltResetStats, including the current frame. Skipped quads
+ * are characters that were clipped or are missing from the atlas. A cache hit
+ * or miss is counted per push, depending on whether the glyphs of the font
+ * were already in the atlas. Bytes are counted by every reallocation of the
+ * buffers, draw lists, texts, glyph tables and the atlas, so they show how
+ * much memory is requested and not how much is in use.
+ *
+ * FreeType time is measured with GLT_TIME_NS, which defaults to a monotonic
+ * clock and can be defined to any clock returning nanoseconds. If
+ * GLT_NO_STATS is defined, the counters are compiled out and stay zero.
+ */
+GLT_API void gltGetStats(GLTstats *stats);
+GLT_API void gltResetStats(void);
+
+/*
+ * Loading fonts, rasterizing glyphs, uploading the atlas, pushing, measuring
+ * and drawing are wrapped in zones, which begin with GLT_ZONE_BEGIN(name) and
+ * end with GLT_ZONE_END(name). By default, the zones are written as Chrome
+ * trace events to the file opened by gltTraceOpen, which can be loaded into
+ * about://tracing or Perfetto. The timestamps come from GLT_TIME_NS. To send
+ * the zones to another profiler, define both macros before including the
+ * implementation. Defining GLT_NO_TRACE removes them.
+ */
+GLT_API GLboolean gltTraceOpen(const char *filename);
+GLT_API void gltTraceClose(void);
+
+/*
+ * A GLTtext lays out a string once with its origin at (0, 0) and keeps the
+ * geometry in GPU buffers. gltDrawTextObject can then draw it any number of
+ * times at different offsets and transforms without building it again.
+ */
+GLT_API void gltSetText(GLTtext *t, char *text);
+GLT_API void gltSetnText(GLTtext *t, char *text, GLsizei count);
+GLT_API void gltDrawTextObject(GLTtext *t, float x, float y);
+GLT_API void gltDeleteText(GLTtext *t);
+
+/*
+ * Replaces the characters in the range [start, start + length) with count
+ * characters from text. Only the quads of the new characters are rebuilt and
+ * uploaded. The following quads are shifted and uploaded only if their
+ * position in the text or their horizontal offset changed.
+ */
+GLT_API void gltReplaceText(GLTtext *t, GLsizei start, GLsizei length, char *text, GLsizei count);
+
+/*
+ * Damage tracking for hosts that only redraw when something changed. Every
+ * retained text remembers the window rectangle it was last drawn into and
+ * where it is tracked again with different content, position, transform,
+ * color or effect, both rectangles are damaged. gltDrawTextObject tracks the
+ * text itself and gltTrackText does so without drawing, so the damage can be
+ * known before anything is drawn. Setting a text to the characters it already
+ * has does nothing at all.
+ *
+ * gltGetDamage returns the union of the damaged rectangles since the last
+ * gltEndFrame in window coordinates as x, y, width and height, which can be
+ * passed to glScissor. It returns GL_FALSE if nothing changed, in which case
+ * the frame does not have to be drawn or presented. Deleting a text or setting
+ * it to an empty string damages its last rectangle. A text that is drawn at
+ * several places in a frame should be split into one text per place.
+ */
+GLT_API void gltTrackText(GLTtext *t, float x, float y);
+GLT_API GLboolean gltGetDamage(GLint *rect);
+
 /*
  * Measures the width of the text using the currently bound font.
  */
@@ -57,10 +548,83 @@ GLT_API float gltMeasurenTextWidth(char *text, GLsizei count);
 GLT_API GLuint gltCreateFont(char *filename, int pixelSize);
 GLT_API void gltBindFont(GLuint font);
 
+/*
+ * gltSetColorRGBA sets the color uniform for all following draws, while
+ * gltSetVertexColorRGBA sets the color of the vertices of all following
+ * pushes. Both colors are multiplied, so text with different vertex colors
+ * can be drawn with a single draw call.
+ */
+GLT_API void gltSetColorRGBA(float r, float g, float b, float a);
+GLT_API void gltSetVertexColorRGBA(float r, float g, float b, float a);
+
+/*
+ * Outlines and shadows are drawn by the fragment shader in the same pass as
+ * the text. gltSetGlyphPadding leaves the given number of empty pixels around
+ * every glyph in the atlas and enlarges every quad by it, so it must be called
+ * before any text is pushed. The outline width and the shadow offset are in
+ * pixels of the font and must not be larger than the padding. A width of zero
+ * or a transparent shadow disables the effect, and text without effects keeps
+ * using the cheaper shaders. The software rasterizer draws no effects.
+ */
+GLT_API void gltSetGlyphPadding(int padding);
+GLT_API void gltSetOutline(float width, float r, float g, float b, float a);
+GLT_API void gltSetShadow(float offsetX, float offsetY, float r, float g, float b, float a);
+
+/*
+ * Sets the viewport used for the default transform, which is an orthographic
+ * projection over the viewport until gltSetTransform is called. The matrix is
+ * only rebuilt when the viewport changes. Without it, the viewport is queried
+ * with glGetIntegerv before every draw, or only once per frame after the first
+ * call to gltEndFrame.
+ */
+GLT_API void gltSetViewport(GLint x, GLint y, GLsizei width, GLsizei height);
 GLT_API void gltOrtho(float left, float right, float bottom, float top, float zNear, float zFar);
 GLT_API void gltSetTransform(float *matrix, GLboolean transpose);
 GLT_API void gltUseProgram(void);
 
+/*
+ * Starts compiling the shaders of the OpenGL backend, so that the first draw
+ * does not have to wait for them. With GL_KHR_parallel_shader_compile, the
+ * driver compiles them in the background and gltIsReady tells whether they are
+ * done without waiting. Otherwise, gltIsReady cannot tell and returns GL_TRUE.
+ *
+ * If cachePath is not NULL, linked programs are stored as binaries in that
+ * directory and loaded from it on the next start. The files are named after
+ * the driver's vendor, renderer and version strings, so a driver update
+ * compiles the programs again. A path of 512 bytes or more disables the
+ * cache.
+ */
+GLT_API void gltInit(const char *cachePath);
+GLT_API GLboolean gltIsReady(void);
+
+typedef struct {
+	GLint program;
+	GLint activeTexture;
+	GLint texture;
+	GLint vertexArray;
+	GLint arrayBuffer;
+	GLboolean blend;
+	GLint blendSrcRGB;
+	GLint blendDstRGB;
+	GLint blendSrcAlpha;
+	GLint blendDstAlpha;
+} GLTstate;
+
+/*
+ * The library remembers the GL state it sets and skips calls which would not
+ * change anything. Objects stay bound after drawing, so if other code changes
+ * the program, the texture of unit zero, the vertex array, the array buffer,
+ * the active texture or the blend state between two text draws, either call
+ * gltInvalidateState afterwards or wrap the text drawing in gltSaveState and
+ * gltRestoreState.
+ *
+ * gltSaveState queries the state from GL, so it costs a few glGet calls.
+ * gltRestoreState sets it again and keeps the library's copy in sync.
+ */
+GLT_API void gltSaveState(GLTstate *state);
+GLT_API void gltRestoreState(const GLTstate *state);
+GLT_API void gltInvalidateState(void);
+
 #endif /* GLTEXT_H */
 
 #ifdef GLT_IMPL
@@ -70,311 +634,4062 @@ GLT_API void gltUseProgram(void);
 #define GLT_REALLOC(p, sz) ((sz) == 0 ? (free(p), NULL) : realloc(p, sz))
 #endif /* GLT_REALLOC */
 
+#ifndef GLT_FRAME_ARENA_SIZE
+#define GLT_FRAME_ARENA_SIZE (256 * 1024)
+#endif /* GLT_FRAME_ARENA_SIZE */
+
+#ifndef GLT_STREAM_SIZE
+#define GLT_STREAM_SIZE (4 * 1024 * 1024)
+#endif /* GLT_STREAM_SIZE */
+
+#ifndef GLT_STREAM_FRAMES
+#define GLT_STREAM_FRAMES 3
+#endif /* GLT_STREAM_FRAMES */
+
+/* Regions start at a whole vertex, so that they can be drawn with a base vertex */
+#define GLT_STREAM_ALIGN (4 * sizeof(GLTvertex))
+#define GLT_STREAM_ROUND(size) \
+	(((size) + GLT_STREAM_ALIGN - 1) / GLT_STREAM_ALIGN * GLT_STREAM_ALIGN)
+
+/* Draws in one call of gltDrawBuffers, the uniform block must fit in 16 KB */
+#ifndef GLT_BATCH_SIZE
+#define GLT_BATCH_SIZE 128
+#endif /* GLT_BATCH_SIZE */
+
+#define GLT_STRING_(x) #x
+#define GLT_STRING(x) GLT_STRING_(x)
+
+#ifndef GLT_BUFFER_DECAY
+#define GLT_BUFFER_DECAY 0
+#endif /* GLT_BUFFER_DECAY */
+
+#define GLT_VERTEX_BYTES (4 * sizeof(GLTvertex))
+#define GLT_INDEX_BYTES (6 * sizeof(GLuint))
+
+#include <stddef.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif /* __SSE2__ */
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif /* GL_COMPLETION_STATUS_KHR */
+
+#ifndef GLT_NO_STATS
+#define GLT_COUNT(name, n) (gltCounters.name += (n))
+#define GLT_STATS_TIME() GLT_TIME_NS()
+#else
+#define GLT_COUNT(name, n) ((void)(n))
+#define GLT_STATS_TIME() 0ull
+#endif /* GLT_NO_STATS */
+
+static GLTcounters gltCounters;
+static GLTcounters gltFrameCounters;
+static GLTcounters gltTotalCounters;
+
+#ifdef GLT_NO_TRACE
+#undef GLT_ZONE_BEGIN
+#undef GLT_ZONE_END
+#define GLT_ZONE_BEGIN(name) ((void)0)
+#define GLT_ZONE_END(name) ((void)0)
+#elif !defined(GLT_ZONE_BEGIN)
+#define GLT_TRACE_SINK
+#define GLT_ZONE_BEGIN(name) gltTraceEvent(name, 'B')
+#define GLT_ZONE_END(name) gltTraceEvent(name, 'E')
+#endif /* GLT_NO_TRACE */
+
+#if !defined(GLT_TIME_NS) && (!defined(GLT_NO_STATS) || defined(GLT_TRACE_SINK))
+#include <time.h>
+#define GLT_TIME_NS() gltTimeNs()
+
+/*
+ * Uses the monotonic clock of POSIX or the wall clock of C11 if time.h
+ * declares them, otherwise the processor time of clock().
+ */
+static unsigned long long
+gltTimeNs(void)
+{
+#if defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#elif defined(TIME_UTC)
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#else
+	return (unsigned long long)clock() * (1000000000ull / CLOCKS_PER_SEC);
+#endif /* CLOCK_MONOTONIC */
+}
+#endif /* GLT_TIME_NS */
+
+static FILE *gltTraceFile;
+static GLboolean gltHasTraceEvent;
+
+#ifdef GLT_TRACE_SINK
+/* Does nothing unless a trace file is open */
+static void
+gltTraceEvent(const char *name, char phase)
+{
+	if (!gltTraceFile) {
+		return;
+	}
+
+	unsigned long long time = GLT_TIME_NS();
+	fprintf(gltTraceFile,
+		"%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":1,\"tid\":1}",
+		gltHasTraceEvent ? ",\n" : "", name, phase, time / 1000, time % 1000);
+	gltHasTraceEvent = GL_TRUE;
+}
+#endif /* GLT_TRACE_SINK */
+
+GLT_API GLboolean
+gltTraceOpen(const char *filename)
+{
+	gltTraceClose();
+	gltTraceFile = fopen(filename, "w");
+	if (!gltTraceFile) {
+		return GL_FALSE;
+	}
+
+	fputs("[\n", gltTraceFile);
+	return GL_TRUE;
+}
+
+GLT_API void
+gltTraceClose(void)
+{
+	if (gltTraceFile) {
+		fputs("\n]\n", gltTraceFile);
+		fclose(gltTraceFile);
+		gltTraceFile = NULL;
+		gltHasTraceEvent = GL_FALSE;
+	}
+}
+
 static GLuint gltProgram;
+static char gltCachePath[512];
+static GLboolean gltHasProgramBinary;
+static GLboolean gltHasParallelCompile;
+
+/*
+ * The OpenGL backend keeps a copy of the uniforms and only uploads those which
+ * changed since the last draw.
+ */
+#define GLT_UNIFORM_TRANSFORM (1 << 0)
+#define GLT_UNIFORM_OFFSET (1 << 1)
+#define GLT_UNIFORM_COLOR (1 << 2)
+#define GLT_UNIFORM_EFFECT (1 << 3)
+
+/* The uniforms of all programs, a program has -1 for those it does not use */
+enum {
+	GLT_LOCATION_TRANSFORM,
+	GLT_LOCATION_OFFSET,
+	GLT_LOCATION_COLOR,
+	GLT_LOCATION_DRAW_BASE,
+	GLT_LOCATION_VIEW,
+	GLT_LOCATION_PROJECTION,
+	GLT_LOCATION_VIEWPORT,
+	GLT_LOCATION_SCALE,
+	GLT_LOCATION_OUTLINE_COLOR,
+	GLT_LOCATION_OUTLINE_WIDTH,
+	GLT_LOCATION_SHADOW_COLOR,
+	GLT_LOCATION_SHADOW_OFFSET,
+	GLT_LOCATION_COUNT,
+};
+
+static const char *gltUniformNames[GLT_LOCATION_COUNT] = {
+	"transform", "offset", "color", "drawBase", "view", "projection", "viewport",
+	"scale", "outlineColor", "outlineWidth", "shadowColor", "shadowOffset",
+};
+
+static GLfloat gltUniformTransform[16];
+static GLfloat gltUniformOffset[2];
+static GLfloat gltUniformColor[4];
+static GLTeffect gltUniformEffect;
+static GLbitfield gltDirtyUniforms;
+
+static GLTbackend *gltBackend;
+static GLfloat gltTransform[16];
+static GLfloat gltColor[4] = {0, 0, 0, 1};
+static GLTeffect gltEffect;
+static int gltGlyphPadding;
 static FT_Face gltFonts[256];
 static GLuint gltFontCount = 1;
 static GLuint gltCurrentFont;
 static GLTcache gltGlobalCache = {0};
 static GLboolean gltHasChangedTransform;
+static GLbitfield gltAtlasStorage = GLT_ATLAS_GPU;
+static GLint gltViewport[4];
+static GLint gltOrthoViewport[4];
+static GLint gltDamage[4];
+static GLboolean gltHasViewport;
+static GLboolean gltHasQueriedViewport;
+static GLboolean gltHasEndedFrame;
 
-static GLuint
-gltCreateShader(GLenum type, const char *source)
+static GLubyte gltVertexColor[4] = {255, 255, 255, 255};
+
+typedef struct GLTarenaBlock GLTarenaBlock;
+struct GLTarenaBlock {
+	GLTarenaBlock *next;
+	GLsizeiptr size;
+	GLsizeiptr used;
+	GLsizeiptr last;
+};
+
+typedef struct {
+	GLTarenaBlock *blocks;
+	GLsizeiptr totalSize;
+} GLTarena;
+
+static GLTarena gltArena;
+
+/*
+ * A region of the ring that belongs to a buffer from the stream allocator.
+ * Live regions have a serial number of zero. Once drawn, a region is freed
+ * when the fence of the frame with the given serial number has signaled.
+ */
+typedef struct {
+	GLsizeiptr start;
+	GLsizeiptr end;
+	GLuint serial;
+} GLTstreamRegion;
+
+/* The geometry of a frame starts at start and ends where the next one starts */
+typedef struct {
+	GLsync sync;
+	GLuint serial;
+	GLsizeiptr start;
+} GLTstreamFence;
+
+/*
+ * Every frame appends its geometry to the ring behind the previous frame and
+ * the space of a frame is reclaimed as a whole once its fence has signaled.
+ * Regions of buffers from the stream allocator can outlive their frame, so
+ * the head skips over them until they are freed.
+ */
+typedef struct {
+	GLboolean isInitialized;
+	GLuint vertexArray;
+	GLuint buffer;
+	unsigned char *mapped;
+	GLsizeiptr head;
+	GLsizeiptr frameStart;
+
+	GLTstreamRegion *regions;
+	int regionCount;
+	int maxRegionCount;
+
+	GLuint serial;
+	GLuint completedSerial;
+	GLboolean hasDrawn;
+	GLTstreamFence fences[GLT_STREAM_FRAMES];
+	int firstFence;
+	int fenceCount;
+
+	GLTstreamStats stats;
+} GLTstream;
+static GLTstream gltStream;
+
+/* Layout of one draw in the uniform block of the batch program (std140) */
+typedef struct {
+	GLfloat transform[16];
+	GLfloat color[4];
+	GLfloat offset[4];
+} GLTdrawParams;
+
+typedef struct {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+} GLTdrawCommand;
+
+/* A range of glyphs of an item, drawn with one command */
+typedef struct {
+	GLsizei item;
+	GLsizei first;
+	GLsizei count;
+	GLsizei param;
+	GLsizei glyphOffset;
+	GLboolean isInPlace;
+} GLTbatchPart;
+
+typedef struct {
+	GLboolean isInitialized;
+	GLboolean hasMultiDraw;
+	GLuint program;
+	GLint drawBaseLocation;
+	GLuint drawBase;
+	GLuint vertexArray;
+	GLuint drawIndexBuffer;
+	GLuint uniformBuffer;
+	GLuint indirectBuffer;
+
+	GLTbatchPart parts[GLT_BATCH_SIZE];
+	GLTdrawParams params[GLT_BATCH_SIZE];
+	GLTdrawCommand commands[GLT_BATCH_SIZE];
+} GLTbatch;
+static GLTbatch gltBatch;
+
+#define GLT_STATE_UNKNOWN ((GLuint)-1)
+
+/* The GL state as last set by the library or unknown */
+typedef struct {
+	GLuint program;
+	GLuint activeTexture;
+	GLuint texture;
+	GLuint vertexArray;
+	GLuint arrayBuffer;
+	GLuint blend;
+	GLuint blendSrc;
+	GLuint blendDst;
+} GLTstateCache;
+static GLTstateCache gltState = {
+	GLT_STATE_UNKNOWN, GLT_STATE_UNKNOWN, GLT_STATE_UNKNOWN, GLT_STATE_UNKNOWN,
+	GLT_STATE_UNKNOWN, GLT_STATE_UNKNOWN, GLT_STATE_UNKNOWN, GLT_STATE_UNKNOWN,
+};
+
+static void
+gltBindProgram(GLuint program)
 {
-	GLuint shader = glCreateShader(type);
-	glShaderSource(shader, 1, &source, NULL);
-	glCompileShader(shader);
+	if (gltState.program != program) {
+		gltState.program = program;
+		glUseProgram(program);
+	}
+}
 
-	int compileStatus = 0;
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
-	if (compileStatus == 0) {
-		char infoLog[1024] = {0};
-		glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
-		fprintf(stderr, "compile error: %s\n", infoLog);
+/* Binds the texture to unit zero, which the shader samples from */
+static void
+gltBindTexture(GLuint texture)
+{
+	if (gltState.activeTexture != GL_TEXTURE0) {
+		gltState.activeTexture = GL_TEXTURE0;
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	if (gltState.texture != texture) {
+		gltState.texture = texture;
+		glBindTexture(GL_TEXTURE_2D, texture);
+	}
+}
+
+static void
+gltBindVertexArray(GLuint vertexArray)
+{
+	if (gltState.vertexArray != vertexArray) {
+		gltState.vertexArray = vertexArray;
+		glBindVertexArray(vertexArray);
+	}
+}
+
+static void
+gltBindArrayBuffer(GLuint buffer)
+{
+	if (gltState.arrayBuffer != buffer) {
+		gltState.arrayBuffer = buffer;
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	}
+}
+
+static void
+gltEnableBlend(void)
+{
+	if (gltState.blend != GL_TRUE) {
+		gltState.blend = GL_TRUE;
+		glEnable(GL_BLEND);
+	}
+
+	if (gltState.blendSrc != GL_SRC_ALPHA || gltState.blendDst != GL_ONE_MINUS_SRC_ALPHA) {
+		gltState.blendSrc = GL_SRC_ALPHA;
+		gltState.blendDst = GL_ONE_MINUS_SRC_ALPHA;
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+}
+
+/* Updates the cache to the state which the user saved or restored */
+static void
+gltSetStateCache(const GLTstate *state)
+{
+	gltState.program = state->program;
+	gltState.activeTexture = GL_TEXTURE0;
+	gltState.texture = state->texture;
+	gltState.vertexArray = state->vertexArray;
+	gltState.arrayBuffer = state->arrayBuffer;
+	gltState.blend = state->blend;
+	if (state->blendSrcRGB == state->blendSrcAlpha && state->blendDstRGB == state->blendDstAlpha) {
+		gltState.blendSrc = state->blendSrcRGB;
+		gltState.blendDst = state->blendDstRGB;
+	} else {
+		gltState.blendSrc = GLT_STATE_UNKNOWN;
+		gltState.blendDst = GLT_STATE_UNKNOWN;
 	}
+}
+
+GLT_API void
+gltSaveState(GLTstate *state)
+{
+	glGetIntegerv(GL_CURRENT_PROGRAM, &state->program);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &state->activeTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &state->texture);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &state->vertexArray);
+	glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &state->arrayBuffer);
+	state->blend = glIsEnabled(GL_BLEND);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &state->blendSrcRGB);
+	glGetIntegerv(GL_BLEND_DST_RGB, &state->blendDstRGB);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &state->blendSrcAlpha);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &state->blendDstAlpha);
+
+	/* Unit zero is still active until the state is restored */
+	gltSetStateCache(state);
+}
+
+GLT_API void
+gltRestoreState(const GLTstate *state)
+{
+	glUseProgram(state->program);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, state->texture);
+	glBindVertexArray(state->vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, state->arrayBuffer);
+	if (state->blend) {
+		glEnable(GL_BLEND);
+	} else {
+		glDisable(GL_BLEND);
+	}
+
+	glBlendFuncSeparate(state->blendSrcRGB, state->blendDstRGB,
+		state->blendSrcAlpha, state->blendDstAlpha);
+
+	gltSetStateCache(state);
+	glActiveTexture(state->activeTexture);
+	gltState.activeTexture = state->activeTexture;
+}
+
+GLT_API void
+gltInvalidateState(void)
+{
+	gltState.program = GLT_STATE_UNKNOWN;
+	gltState.activeTexture = GLT_STATE_UNKNOWN;
+	gltState.texture = GLT_STATE_UNKNOWN;
+	gltState.vertexArray = GLT_STATE_UNKNOWN;
+	gltState.arrayBuffer = GLT_STATE_UNKNOWN;
+	gltState.blend = GLT_STATE_UNKNOWN;
+	gltState.blendSrc = GLT_STATE_UNKNOWN;
+	gltState.blendDst = GLT_STATE_UNKNOWN;
+}
+
+static GLboolean
+gltStringEquals(const char *a, const char *b)
+{
+	while (*a && *a == *b) {
+		a++;
+		b++;
+	}
+
+	return *a == *b;
+}
+
+static GLboolean
+gltHasExtension(const char *name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++) {
+		const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && gltStringEquals(extension, name)) {
+			return GL_TRUE;
+		}
+	}
+
+	return GL_FALSE;
+}
+
+static GLboolean
+gltHasVersion(GLint major, GLint minor)
+{
+	GLint currentMajor = 0;
+	GLint currentMinor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &currentMajor);
+	glGetIntegerv(GL_MINOR_VERSION, &currentMinor);
+	return currentMajor > major || (currentMajor == major && currentMinor >= minor);
+}
+
+static const char *gltVertexSource = "#version 330 core\n"
+	"layout (location = 0) in vec2 aPos;\n"
+	"layout (location = 1) in vec2 aTexCoords;\n"
+	"layout (location = 2) in vec4 aColor;\n"
+	"uniform mat4 transform;\n"
+	"uniform vec2 offset;\n"
+	"out vec2 vTexCoords;\n"
+	"out vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"    vTexCoords = aTexCoords;\n"
+	"    vColor = aColor;\n"
+	"    gl_Position = transform * vec4(aPos + offset, 0.0, 1.0);\n"
+	"}\n";
+
+#define GLT_SHADE_SOURCE \
+	"vec4 shade(sampler2D atlas, vec2 uv, vec4 fill)\n" \
+	"{\n" \
+	"    return mix(vec4(0), fill, texture(atlas, uv).r);\n" \
+	"}\n"
+
+/*
+ * Composites the shadow, the outline and the text from back to front. The
+ * outline is the largest coverage on two rings around the texel. The rows of
+ * the atlas run downwards, so the shadow offset is flipped vertically. Even
+ * disabled, the effects slow down some drivers, so every program has a
+ * variant with and without them.
+ */
+#define GLT_EFFECT_SOURCE \
+	"uniform vec4 outlineColor;\n" \
+	"uniform float outlineWidth;\n" \
+	"uniform vec4 shadowColor;\n" \
+	"uniform vec2 shadowOffset;\n" \
+	"vec4 shade(sampler2D atlas, vec2 uv, vec4 fill)\n" \
+	"{\n" \
+	"    vec2 texel = 1.0 / vec2(textureSize(atlas, 0));\n" \
+	"    float alpha = texture(atlas, uv).r;\n" \
+	"    vec4 result = vec4(0);\n" \
+	"    if (shadowColor.a > 0.0) {\n" \
+	"        vec2 offset = vec2(-shadowOffset.x, shadowOffset.y) * texel;\n" \
+	"        result = mix(result, shadowColor, texture(atlas, uv + offset).r);\n" \
+	"    }\n" \
+	"    if (outlineWidth > 0.0) {\n" \
+	"        float outline = alpha;\n" \
+	"        for (int i = 0; i < 16; i++) {\n" \
+	"            float angle = float(i) * 0.39269908;\n" \
+	"            vec2 direction = vec2(cos(angle), sin(angle)) * texel * outlineWidth;\n" \
+	"            outline = max(outline, texture(atlas, uv + direction).r);\n" \
+	"            outline = max(outline, texture(atlas, uv + 0.5 * direction).r);\n" \
+	"        }\n" \
+	"        result = mix(result, outlineColor, outline);\n" \
+	"    }\n" \
+	"    return mix(result, fill, alpha);\n" \
+	"}\n"
+
+#define GLT_FRAGMENT_SOURCE(shade) "#version 330 core\n" \
+	"in vec2 vTexCoords;\n" \
+	"in vec4 vColor;\n" \
+	"uniform vec4 color;\n" \
+	"uniform sampler2D textureAtlas;\n" \
+	"out vec4 fragColor;\n" \
+	shade \
+	"void main()\n" \
+	"{\n" \
+	"    fragColor = shade(textureAtlas, vTexCoords, color * vColor);\n" \
+	"}\n"
+
+static const char *gltFragmentSource = GLT_FRAGMENT_SOURCE(GLT_SHADE_SOURCE);
+static const char *gltEffectFragmentSource = GLT_FRAGMENT_SOURCE(GLT_EFFECT_SOURCE);
+
+static const char *gltLabelVertexSource = "#version 330 core\n"
+	"layout (location = 0) in vec3 aAnchor;\n"
+	"layout (location = 1) in vec2 aOffset;\n"
+	"layout (location = 2) in vec2 aTexCoords;\n"
+	"layout (location = 3) in vec4 aColor;\n"
+	"uniform mat4 view;\n"
+	"uniform mat4 projection;\n"
+	"uniform vec2 viewport;\n"
+	"uniform float scale;\n"
+	"out vec2 vTexCoords;\n"
+	"out vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"    vTexCoords = aTexCoords;\n"
+	"    vColor = aColor;\n"
+	"    vec4 position = view * vec4(aAnchor, 1.0);\n"
+	"    if (scale > 0.0) {\n"
+	"        position.xy += aOffset * scale;\n"
+	"        gl_Position = projection * position;\n"
+	"    } else {\n"
+	"        gl_Position = projection * position;\n"
+	"        gl_Position.xy += 2.0 * aOffset / viewport * gl_Position.w;\n"
+	"    }\n"
+	"}\n";
+
+static const char *gltBatchVertexSource = "#version 330 core\n"
+	"layout (location = 0) in vec2 aPos;\n"
+	"layout (location = 1) in vec2 aTexCoords;\n"
+	"layout (location = 2) in vec4 aColor;\n"
+	"layout (location = 3) in uint aDrawIndex;\n"
+	"struct Draw { mat4 transform; vec4 color; vec4 offset; };\n"
+	"layout (std140) uniform Draws { Draw draws[" GLT_STRING(GLT_BATCH_SIZE) "]; };\n"
+	"uniform uint drawBase;\n"
+	"out vec2 vTexCoords;\n"
+	"out vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"    Draw draw = draws[aDrawIndex + drawBase];\n"
+	"    vTexCoords = aTexCoords;\n"
+	"    vColor = draw.color * aColor;\n"
+	"    gl_Position = draw.transform * vec4(aPos + draw.offset.xy, 0.0, 1.0);\n"
+	"}\n";
+
+#define GLT_BATCH_FRAGMENT_SOURCE(shade) "#version 330 core\n" \
+	"in vec2 vTexCoords;\n" \
+	"in vec4 vColor;\n" \
+	"uniform sampler2D textureAtlas;\n" \
+	"out vec4 fragColor;\n" \
+	shade \
+	"void main()\n" \
+	"{\n" \
+	"    fragColor = shade(textureAtlas, vTexCoords, vColor);\n" \
+	"}\n"
+
+static const char *gltBatchFragmentSource = GLT_BATCH_FRAGMENT_SOURCE(GLT_SHADE_SOURCE);
+static const char *gltBatchEffectFragmentSource = GLT_BATCH_FRAGMENT_SOURCE(GLT_EFFECT_SOURCE);
+
+/*
+ * A program is started by gltInit or its first use and only checked when it
+ * is needed, so that the driver can compile it in the meantime.
+ */
+typedef struct {
+	const char *name;
+	const char **vertexSource;
+	const char **fragmentSource;
+	GLuint program;
+	GLuint vertexShader;
+	GLuint fragmentShader;
+	GLboolean isFinished;
+	GLint locations[GLT_LOCATION_COUNT];
+
+	/* The effect in the uniforms of the program, if they were set already */
+	GLTeffect effect;
+	GLboolean hasEffect;
+} GLTprogram;
+
+static GLTprogram gltTextProgram = {
+	.name = "text", .vertexSource = &gltVertexSource,
+	.fragmentSource = &gltFragmentSource,
+};
+
+static GLTprogram gltTextEffectProgram = {
+	.name = "text-effect", .vertexSource = &gltVertexSource,
+	.fragmentSource = &gltEffectFragmentSource,
+};
+
+static GLTprogram gltBatchProgram = {
+	.name = "batch", .vertexSource = &gltBatchVertexSource,
+	.fragmentSource = &gltBatchFragmentSource,
+};
+
+static GLTprogram gltBatchEffectProgram = {
+	.name = "batch-effect", .vertexSource = &gltBatchVertexSource,
+	.fragmentSource = &gltBatchEffectFragmentSource,
+};
+
+static GLTprogram gltLabelProgram = {
+	.name = "label", .vertexSource = &gltLabelVertexSource,
+	.fragmentSource = &gltFragmentSource,
+};
+
+static GLTprogram gltLabelEffectProgram = {
+	.name = "label-effect", .vertexSource = &gltLabelVertexSource,
+	.fragmentSource = &gltEffectFragmentSource,
+};
+
+static GLTprogram *gltPrograms[] = {
+	&gltTextProgram, &gltTextEffectProgram, &gltBatchProgram,
+	&gltBatchEffectProgram, &gltLabelProgram, &gltLabelEffectProgram,
+};
+
+/* The variant of the text program that gltProgram refers to */
+static GLTprogram *gltTextVariant;
+
+static GLuint
+gltCreateShader(GLenum type, const char *source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+static void
+gltCheckShader(GLuint shader)
+{
+	int compileStatus = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+	if (compileStatus == 0) {
+		char infoLog[1024] = {0};
+		glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+		fprintf(stderr, "compile error: %s\n", infoLog);
+	}
+}
+
+#ifdef GL_PROGRAM_BINARY_LENGTH
+static unsigned long long
+gltHashString(unsigned long long hash, const char *string)
+{
+	while (string && *string) {
+		hash = (hash ^ (unsigned char)*string++) * 1099511628211ull;
+	}
+
+	return hash;
+}
+
+/* Names the cache file after the driver and the sources of the program */
+static void
+gltProgramCacheFile(GLTprogram *p, char *path, int size)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	hash = gltHashString(hash, (const char *)glGetString(GL_VENDOR));
+	hash = gltHashString(hash, (const char *)glGetString(GL_RENDERER));
+	hash = gltHashString(hash, (const char *)glGetString(GL_VERSION));
+	hash = gltHashString(hash, *p->vertexSource);
+	hash = gltHashString(hash, *p->fragmentSource);
+	snprintf(path, size, "%s/gltext-%s-%016llx.bin", gltCachePath, p->name, hash);
+}
+
+/* Avoids a GL error for files written by another driver */
+static GLboolean
+gltIsProgramBinaryFormat(GLenum format)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+	GLint *formats = count > 0 ? (GLint *)GLT_REALLOC(NULL, count * sizeof(*formats)) : NULL;
+	if (!formats) {
+		return GL_FALSE;
+	}
+
+	GLboolean result = GL_FALSE;
+	glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats);
+	for (GLint i = 0; i < count; i++) {
+		if ((GLenum)formats[i] == format) {
+			result = GL_TRUE;
+		}
+	}
+
+	(void)GLT_REALLOC(formats, 0);
+	return result;
+}
+
+static GLboolean
+gltLoadProgramBinary(GLTprogram *p)
+{
+	if (!gltHasProgramBinary || !gltCachePath[0]) {
+		return GL_FALSE;
+	}
+
+	char path[640];
+	gltProgramCacheFile(p, path, sizeof(path));
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		return GL_FALSE;
+	}
+
+	GLenum format = 0;
+	long size = 0;
+	void *binary = NULL;
+	if (fseek(file, 0, SEEK_END) == 0) {
+		size = ftell(file) - (long)sizeof(format);
+		rewind(file);
+	}
+
+	if (size > 0 && fread(&format, sizeof(format), 1, file) == 1) {
+		binary = GLT_REALLOC(NULL, size);
+		if (binary && fread(binary, 1, size, file) != (size_t)size) {
+			binary = GLT_REALLOC(binary, 0);
+		}
+	}
+
+	fclose(file);
+	if (binary && !gltIsProgramBinaryFormat(format)) {
+		binary = GLT_REALLOC(binary, 0);
+	}
+
+	if (!binary) {
+		return GL_FALSE;
+	}
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, format, binary, size);
+	(void)GLT_REALLOC(binary, 0);
+
+	/* The binary is rejected if the driver changed in an unnoticed way */
+	int linkStatus = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == 0) {
+		glDeleteProgram(program);
+		return GL_FALSE;
+	}
+
+	p->program = program;
+	return GL_TRUE;
+}
+
+static void
+gltSaveProgramBinary(GLTprogram *p)
+{
+	if (!gltHasProgramBinary || !gltCachePath[0]) {
+		return;
+	}
+
+	GLint size = 0;
+	glGetProgramiv(p->program, GL_PROGRAM_BINARY_LENGTH, &size);
+	void *binary = size > 0 ? GLT_REALLOC(NULL, size) : NULL;
+	if (!binary) {
+		return;
+	}
+
+	GLenum format = 0;
+	glGetProgramBinary(p->program, size, NULL, &format, binary);
+
+	char path[640];
+	gltProgramCacheFile(p, path, sizeof(path));
+	FILE *file = fopen(path, "wb");
+	if (file) {
+		fwrite(&format, sizeof(format), 1, file);
+		fwrite(binary, 1, size, file);
+		fclose(file);
+	}
+
+	(void)GLT_REALLOC(binary, 0);
+}
+#endif /* GL_PROGRAM_BINARY_LENGTH */
+
+/* Loads the program from the cache or starts compiling it without waiting */
+static void
+gltStartProgram(GLTprogram *p)
+{
+	if (p->program) {
+		return;
+	}
+
+#ifdef GL_PROGRAM_BINARY_LENGTH
+	if (gltLoadProgramBinary(p)) {
+		return;
+	}
+#endif /* GL_PROGRAM_BINARY_LENGTH */
+
+	p->vertexShader = gltCreateShader(GL_VERTEX_SHADER, *p->vertexSource);
+	p->fragmentShader = gltCreateShader(GL_FRAGMENT_SHADER, *p->fragmentSource);
+
+	p->program = glCreateProgram();
+	glAttachShader(p->program, p->vertexShader);
+	glAttachShader(p->program, p->fragmentShader);
+#ifdef GL_PROGRAM_BINARY_LENGTH
+	if (gltHasProgramBinary && gltCachePath[0]) {
+		glProgramParameteri(p->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+#endif /* GL_PROGRAM_BINARY_LENGTH */
+	glLinkProgram(p->program);
+}
+
+/* Waits for the program, reports errors and stores it in the cache */
+static GLuint
+gltFinishProgram(GLTprogram *p)
+{
+	gltStartProgram(p);
+	if (p->isFinished) {
+		return p->program;
+	}
+
+	p->isFinished = GL_TRUE;
+	if (p->vertexShader) {
+		gltCheckShader(p->vertexShader);
+		gltCheckShader(p->fragmentShader);
+
+		int linkStatus = 0;
+		glGetProgramiv(p->program, GL_LINK_STATUS, &linkStatus);
+		if (linkStatus == 0) {
+			char infoLog[1024] = {0};
+			glGetProgramInfoLog(p->program, sizeof(infoLog), NULL, infoLog);
+			fprintf(stderr, "link error: %s\n", infoLog);
+		}
+#ifdef GL_PROGRAM_BINARY_LENGTH
+		else {
+			gltSaveProgramBinary(p);
+		}
+#endif /* GL_PROGRAM_BINARY_LENGTH */
+
+		glDeleteShader(p->vertexShader);
+		glDeleteShader(p->fragmentShader);
+		p->vertexShader = 0;
+		p->fragmentShader = 0;
+	}
+
+	for (int i = 0; i < GLT_LOCATION_COUNT; i++) {
+		p->locations[i] = glGetUniformLocation(p->program, gltUniformNames[i]);
+	}
+
+	return p->program;
+}
+
+GLT_API void
+gltInit(const char *cachePath)
+{
+	int length = 0;
+	while (cachePath && cachePath[length] && length + 1 < (int)sizeof(gltCachePath)) {
+		gltCachePath[length] = cachePath[length];
+		length++;
+	}
+
+	/* A truncated path would name another directory, so the cache stays off */
+	if (cachePath && cachePath[length]) {
+		length = 0;
+	}
+
+	gltCachePath[length] = '\0';
+
+#ifdef GL_PROGRAM_BINARY_LENGTH
+	GLint formatCount = 0;
+	if (gltHasVersion(4, 1) || gltHasExtension("GL_ARB_get_program_binary")) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	}
+
+	gltHasProgramBinary = formatCount > 0;
+#endif /* GL_PROGRAM_BINARY_LENGTH */
+
+	gltHasParallelCompile = gltHasExtension("GL_KHR_parallel_shader_compile")
+		|| gltHasExtension("GL_ARB_parallel_shader_compile");
+
+	for (size_t i = 0; i < sizeof(gltPrograms) / sizeof(*gltPrograms); i++) {
+		gltStartProgram(gltPrograms[i]);
+	}
+}
+
+GLT_API GLboolean
+gltIsReady(void)
+{
+	for (size_t i = 0; i < sizeof(gltPrograms) / sizeof(*gltPrograms); i++) {
+		GLTprogram *p = gltPrograms[i];
+		if (!p->program) {
+			return GL_FALSE;
+		}
+
+		if (!p->isFinished && gltHasParallelCompile) {
+			GLint isComplete = GL_FALSE;
+			glGetProgramiv(p->program, GL_COMPLETION_STATUS_KHR, &isComplete);
+			if (!isComplete) {
+				return GL_FALSE;
+			}
+		}
+	}
+
+	return GL_TRUE;
+}
+
+static GLboolean
+gltHasEffect(const GLTeffect *effect)
+{
+	return effect->outlineWidth > 0 || effect->shadowColor[3] > 0;
+}
+
+/* Sets the effect uniforms of the bound program */
+static void
+gltSetEffectUniforms(const GLint *locations, const GLTeffect *effect)
+{
+	glUniform4fv(locations[GLT_LOCATION_OUTLINE_COLOR], 1, effect->outlineColor);
+	glUniform1f(locations[GLT_LOCATION_OUTLINE_WIDTH], effect->outlineWidth);
+	glUniform4fv(locations[GLT_LOCATION_SHADOW_COLOR], 1, effect->shadowColor);
+	glUniform2fv(locations[GLT_LOCATION_SHADOW_OFFSET], 1, effect->shadowOffset);
+}
+
+static GLboolean
+gltEffectEquals(const GLTeffect *a, const GLTeffect *b)
+{
+	for (int i = 0; i < 4; i++) {
+		if (a->outlineColor[i] != b->outlineColor[i] || a->shadowColor[i] != b->shadowColor[i]) {
+			return GL_FALSE;
+		}
+	}
+
+	return a->outlineWidth == b->outlineWidth
+		&& a->shadowOffset[0] == b->shadowOffset[0]
+		&& a->shadowOffset[1] == b->shadowOffset[1];
+}
+
+/*
+ * Sets the effect uniforms of the bound program, unless it has none or they
+ * already hold the effect.
+ */
+static void
+gltUseEffect(GLTprogram *p, const GLTeffect *effect)
+{
+	if (!gltHasEffect(effect) || (p->hasEffect && gltEffectEquals(&p->effect, effect))) {
+		return;
+	}
+
+	p->effect = *effect;
+	p->hasEffect = GL_TRUE;
+	gltSetEffectUniforms(p->locations, effect);
+}
+
+/* Binds the program and the texture and updates the uniforms of the state */
+static void
+gltGLUseState(const GLTdrawState *state)
+{
+	/* The shadowed uniforms belong to the variant that was used last */
+	GLTprogram *p = gltHasEffect(&state->effect) ? &gltTextEffectProgram : &gltTextProgram;
+	if (p != gltTextVariant) {
+		gltTextVariant = p;
+		gltProgram = gltFinishProgram(p);
+		gltDirtyUniforms = GLT_UNIFORM_TRANSFORM | GLT_UNIFORM_OFFSET | GLT_UNIFORM_COLOR
+			| GLT_UNIFORM_EFFECT;
+	}
+
+	for (int i = 0; i < 16; i++) {
+		if (gltUniformTransform[i] != state->transform[i]) {
+			gltUniformTransform[i] = state->transform[i];
+			gltDirtyUniforms |= GLT_UNIFORM_TRANSFORM;
+		}
+	}
+
+	for (int i = 0; i < 2; i++) {
+		if (gltUniformOffset[i] != state->offset[i]) {
+			gltUniformOffset[i] = state->offset[i];
+			gltDirtyUniforms |= GLT_UNIFORM_OFFSET;
+		}
+	}
+
+	for (int i = 0; i < 4; i++) {
+		if (gltUniformColor[i] != state->color[i]) {
+			gltUniformColor[i] = state->color[i];
+			gltDirtyUniforms |= GLT_UNIFORM_COLOR;
+		}
+	}
+
+	if (!gltEffectEquals(&gltUniformEffect, &state->effect)) {
+		gltUniformEffect = state->effect;
+		gltDirtyUniforms |= GLT_UNIFORM_EFFECT;
+	}
+
+	gltEnableBlend();
+	gltBindProgram(gltProgram);
+	gltBindTexture(state->texture);
+
+	if (gltDirtyUniforms & GLT_UNIFORM_TRANSFORM) {
+		glUniformMatrix4fv(p->locations[GLT_LOCATION_TRANSFORM], 1, GL_FALSE, gltUniformTransform);
+	}
+
+	if (gltDirtyUniforms & GLT_UNIFORM_OFFSET) {
+		glUniform2fv(p->locations[GLT_LOCATION_OFFSET], 1, gltUniformOffset);
+	}
+
+	if (gltDirtyUniforms & GLT_UNIFORM_COLOR) {
+		glUniform4fv(p->locations[GLT_LOCATION_COLOR], 1, gltUniformColor);
+	}
+
+	/* The plain variant has no effect uniforms */
+	if ((gltDirtyUniforms & GLT_UNIFORM_EFFECT) && p == &gltTextEffectProgram) {
+		gltSetEffectUniforms(p->locations, &gltUniformEffect);
+	}
+
+	gltDirtyUniforms = 0;
+}
+
+static GLTbackend *
+gltCurrentBackend(void)
+{
+	return gltBackend ? gltBackend : gltGLBackend();
+}
+
+/* Creates the atlas texture of a new backend from the copy in memory */
+static void
+gltRestoreAtlas(void)
+{
+	GLTcache *cache = &gltGlobalCache;
+	float height = cache->currentOffsetY + cache->currentRowHeight;
+	if (cache->textureAtlas || !cache->pixels || !(gltAtlasStorage & GLT_ATLAS_GPU)
+			|| height <= 0) {
+		return;
+	}
+
+	GLTbackend *backend = gltCurrentBackend();
+	cache->textureAtlas = backend->createTexture(backend->user, 1024, 1024);
+	if (cache->textureAtlas) {
+		backend->updateTexture(backend->user, cache->textureAtlas,
+			0, 0, 1024, height, 1024, cache->pixels);
+	}
+}
+
+/* Fills in the current transform, color and atlas */
+static void
+gltInitDrawState(GLTdrawState *state, float x, float y)
+{
+	for (int i = 0; i < 16; i++) {
+		state->transform[i] = gltTransform[i];
+	}
+
+	for (int i = 0; i < 4; i++) {
+		state->color[i] = gltColor[i];
+	}
+
+	state->offset[0] = x;
+	state->offset[1] = y;
+	gltRestoreAtlas();
+	state->texture = gltGlobalCache.textureAtlas;
+	state->effect = gltEffect;
+}
+
+GLT_API void
+gltUseProgram(void)
+{
+	GLTdrawState state;
+	gltInitDrawState(&state, 0, 0);
+	GLTbackend *backend = gltCurrentBackend();
+	if (backend->useProgram) {
+		backend->useProgram(backend->user, &state);
+	}
+}
+
+GLT_API void
+gltSetTransform(float *matrix, GLboolean transpose)
+{
+	gltHasChangedTransform = 1;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			gltTransform[4 * i + j] = transpose ? matrix[4 * j + i] : matrix[4 * i + j];
+		}
+	}
+}
+
+GLT_API void
+gltSetColorRGBA(float r, float g, float b, float a)
+{
+	gltColor[0] = r;
+	gltColor[1] = g;
+	gltColor[2] = b;
+	gltColor[3] = a;
+}
+
+GLT_API void
+gltSetGlyphPadding(int padding)
+{
+	gltGlyphPadding = padding > 0 ? padding : 0;
+}
+
+GLT_API void
+gltSetOutline(float width, float r, float g, float b, float a)
+{
+	gltEffect.outlineWidth = width;
+	gltEffect.outlineColor[0] = r;
+	gltEffect.outlineColor[1] = g;
+	gltEffect.outlineColor[2] = b;
+	gltEffect.outlineColor[3] = a;
+}
+
+GLT_API void
+gltSetShadow(float offsetX, float offsetY, float r, float g, float b, float a)
+{
+	gltEffect.shadowOffset[0] = offsetX;
+	gltEffect.shadowOffset[1] = offsetY;
+	gltEffect.shadowColor[0] = r;
+	gltEffect.shadowColor[1] = g;
+	gltEffect.shadowColor[2] = b;
+	gltEffect.shadowColor[3] = a;
+}
+
+/*
+ * Rounds a channel to a byte. It is clamped first, since converting a value
+ * outside of [0, 255] to an unsigned type is undefined.
+ */
+static GLubyte
+gltColorByte(float value)
+{
+	if (value <= 0) {
+		return 0;
+	}
+
+	if (value >= 255) {
+		return 255;
+	}
+
+	return value + 0.5f;
+}
+
+GLT_API void
+gltSetVertexColorRGBA(float r, float g, float b, float a)
+{
+	gltVertexColor[0] = gltColorByte(r * 255);
+	gltVertexColor[1] = gltColorByte(g * 255);
+	gltVertexColor[2] = gltColorByte(b * 255);
+	gltVertexColor[3] = gltColorByte(a * 255);
+}
+
+GLT_API void
+gltSetViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	gltViewport[0] = x;
+	gltViewport[1] = y;
+	gltViewport[2] = width;
+	gltViewport[3] = height;
+	gltHasViewport = 1;
+}
+
+GLT_API void
+gltOrtho(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+	float matrix[4][4] = {0};
+
+	matrix[0][0] = 2. / (right - left);
+	matrix[1][1] = 2. / (top - bottom);
+	matrix[2][2] = -2. / (zFar - zNear);
+	matrix[3][3] = 1.;
+
+	matrix[0][3] = - (right + left) / (right - left);
+	matrix[1][3] = - (top + bottom) / (top - bottom);
+	matrix[2][3] = - (zFar + zNear) / (zFar - zNear);
+
+	gltSetTransform(matrix[0], GL_TRUE);
+}
+
+static void
+gltMoveMemory(void *dst, const void *src, GLsizeiptr size)
+{
+	unsigned char *d = (unsigned char *)dst;
+	const unsigned char *s = (const unsigned char *)src;
+	if (d < s) {
+		while (size-- > 0) {
+			*d++ = *s++;
+		}
+	} else {
+		while (size-- > 0) {
+			d[size] = s[size];
+		}
+	}
+}
+
+static void *
+gltRealloc(GLTallocator *allocator, void *ptr, GLsizeiptr oldSize, GLsizeiptr newSize)
+{
+	if (newSize > 0) {
+		GLT_COUNT(reallocCount, 1);
+		GLT_COUNT(allocatedBytes, newSize);
+	}
+
+	if (allocator) {
+		return allocator->realloc(allocator->user, ptr, oldSize, newSize);
+	} else {
+		return GLT_REALLOC(ptr, newSize);
+	}
+}
+
+#define GLT_ARENA_ALIGN(size) (((size) + 15) & ~(GLsizeiptr)15)
+#define GLT_ARENA_DATA(block) ((unsigned char *)(block) + GLT_ARENA_ALIGN(sizeof(GLTarenaBlock)))
+
+/*
+ * Allocates linearly from the newest block of the arena. The most recent
+ * allocation can grow, shrink and be freed in place, which is all that a
+ * temporary GLTbuffer needs. Everything else is only released by
+ * gltEndFrame.
+ */
+static void *
+gltArenaRealloc(void *user, void *ptr, GLsizeiptr oldSize, GLsizeiptr newSize)
+{
+	GLTarena *arena = (GLTarena *)user;
+	GLTarenaBlock *block = arena->blocks;
+
+	newSize = GLT_ARENA_ALIGN(newSize);
+	if (block && ptr == GLT_ARENA_DATA(block) + block->last
+			&& block->last + newSize <= block->size) {
+		block->used = block->last + newSize;
+		return newSize > 0 ? ptr : NULL;
+	}
+
+	if (newSize == 0) {
+		return NULL;
+	}
+
+	if (newSize <= oldSize) {
+		return ptr;
+	}
+
+	if (!block || block->used + newSize > block->size) {
+		GLsizeiptr size = GLT_FRAME_ARENA_SIZE;
+		if (block && size < 2 * block->size) {
+			size = 2 * block->size;
+		}
+
+		if (size < newSize) {
+			size = newSize;
+		}
+
+		GLTarenaBlock *newBlock = (GLTarenaBlock *)GLT_REALLOC(NULL,
+			GLT_ARENA_ALIGN(sizeof(GLTarenaBlock)) + size);
+		if (!newBlock) {
+			return NULL;
+		}
+
+		newBlock->next = block;
+		newBlock->size = size;
+		newBlock->used = 0;
+		newBlock->last = 0;
+		arena->blocks = block = newBlock;
+		arena->totalSize += size;
+	}
+
+	unsigned char *result = GLT_ARENA_DATA(block) + block->used;
+	block->last = block->used;
+	block->used += newSize;
+	if (ptr) {
+		gltMoveMemory(result, ptr, oldSize);
+	}
+
+	return result;
+}
+
+GLT_API GLTallocator *
+gltFrameAllocator(void)
+{
+	static GLTallocator allocator = { gltArenaRealloc, &gltArena };
+	return &allocator;
+}
+
+/*
+ * Changes the capacity of the buffer to exactly maxGlyphCount glyphs, which
+ * must not be less than the number of glyphs in the buffer. Since the indices
+ * are stored after the vertices, they have to move whenever the capacity
+ * changes.
+ */
+static GLboolean
+gltBufferResize(GLTbuffer *b, GLsizei maxGlyphCount)
+{
+	unsigned char *data = (unsigned char *)b->vertices;
+	GLsizeiptr indexSize = b->indexCount * sizeof(*b->indices);
+
+	if (maxGlyphCount < b->maxGlyphCount) {
+		gltMoveMemory(data + maxGlyphCount * GLT_VERTEX_BYTES, b->indices, indexSize);
+	}
+
+	unsigned char *newData = (unsigned char *)gltRealloc(b->allocator, data,
+		b->maxGlyphCount * (GLT_VERTEX_BYTES + GLT_INDEX_BYTES),
+		maxGlyphCount * (GLT_VERTEX_BYTES + GLT_INDEX_BYTES));
+	if (!newData && maxGlyphCount > 0) {
+		if (maxGlyphCount > b->maxGlyphCount) {
+			return GL_FALSE;
+		}
+
+		/* The old block is still valid and large enough for the new layout */
+		newData = data;
+	}
+
+	if (maxGlyphCount > b->maxGlyphCount) {
+		gltMoveMemory(newData + maxGlyphCount * GLT_VERTEX_BYTES,
+			newData + b->maxGlyphCount * GLT_VERTEX_BYTES, indexSize);
+	}
+
+	b->vertices = (GLTvertex *)newData;
+	b->indices = (GLuint *)(newData + maxGlyphCount * GLT_VERTEX_BYTES);
+	b->maxGlyphCount = maxGlyphCount;
+	if (maxGlyphCount == 0) {
+		b->vertices = NULL;
+		b->indices = NULL;
+	}
+
+	return GL_TRUE;
+}
+
+GLT_API GLboolean
+gltBufferReserve(GLTbuffer *b, GLsizei glyphCount)
+{
+	if (glyphCount <= b->maxGlyphCount) {
+		return GL_TRUE;
+	}
+
+	GLsizei maxGlyphCount = b->maxGlyphCount;
+	if (maxGlyphCount == 0) {
+		maxGlyphCount = 256;
+	}
+
+	while (maxGlyphCount < glyphCount) {
+		maxGlyphCount *= 2;
+	}
+
+	return gltBufferResize(b, maxGlyphCount);
+}
+
+GLT_API void
+gltBufferShrink(GLTbuffer *b)
+{
+	gltBufferResize(b, b->vertexCount / 4);
+	b->highWaterMark = b->vertexCount / 4;
+}
+
+GLT_API void
+gltBufferFree(GLTbuffer *b)
+{
+	b->vertices = (GLTvertex *)gltRealloc(b->allocator, b->vertices,
+		b->maxGlyphCount * (GLT_VERTEX_BYTES + GLT_INDEX_BYTES), 0);
+	b->vertexCount = 0;
+	b->indices = NULL;
+	b->indexCount = 0;
+	b->maxGlyphCount = 0;
+	b->highWaterMark = 0;
+}
+
+/*
+ * Creates a vertex array which reads vertices and indices from the given
+ * buffers starting at offset zero.
+ */
+static GLuint
+gltCreateVertexArray(GLuint vertexBuffer, GLuint indexBuffer)
+{
+	GLuint vertexArray = 0;
+	glGenVertexArrays(1, &vertexArray);
+	gltBindVertexArray(vertexArray);
+	gltBindArrayBuffer(vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLTvertex),
+		(void *)offsetof(GLTvertex, x));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLTvertex),
+		(void *)offsetof(GLTvertex, u));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GLTvertex),
+		(void *)offsetof(GLTvertex, color));
+
+	return vertexArray;
+}
+
+/*
+ * Uses an orthographic projection of the viewport if the user never set a
+ * transform.
+ */
+static void
+gltUpdateViewport(void)
+{
+	if (!gltHasViewport && !gltHasQueriedViewport) {
+		/*
+		 * Query at most once per frame, a glGet may stall the driver. Without
+		 * gltEndFrame, there are no frames and every draw has to query it.
+		 */
+		GLTbackend *backend = gltCurrentBackend();
+		backend->getViewport(backend->user, gltViewport);
+		gltHasQueriedViewport = gltHasEndedFrame;
+	}
+}
+
+static void
+gltUpdateTransform(void)
+{
+	if (gltHasChangedTransform) {
+		return;
+	}
+
+	gltUpdateViewport();
+	GLint *viewport = gltViewport;
+	if (viewport[0] != gltOrthoViewport[0] || viewport[1] != gltOrthoViewport[1]
+			|| viewport[2] != gltOrthoViewport[2] || viewport[3] != gltOrthoViewport[3]) {
+		float left = viewport[0];
+		float right = left + viewport[2];
+		float bottom = viewport[1];
+		float top = bottom + viewport[3];
+		gltOrtho(left, right, bottom, top, -1, 1);
+
+		for (int i = 0; i < 4; i++) {
+			gltOrthoViewport[i] = viewport[i];
+		}
+
+		/* To keep following the viewport until the user sets it */
+		gltHasChangedTransform = 0;
+	}
+}
+
+static void
+gltStreamInit(GLTstream *stream)
+{
+	if (stream->isInitialized) {
+		return;
+	}
+
+	stream->isInitialized = GL_TRUE;
+	stream->serial = 1;
+	glGenBuffers(1, &stream->buffer);
+	gltBindArrayBuffer(stream->buffer);
+
+#ifdef GL_MAP_PERSISTENT_BIT
+	if (gltHasVersion(4, 4) || gltHasExtension("GL_ARB_buffer_storage")) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, GLT_STREAM_SIZE, NULL, flags);
+		stream->mapped = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER,
+			0, GLT_STREAM_SIZE, flags);
+	}
+#endif /* GL_MAP_PERSISTENT_BIT */
+
+	if (!stream->mapped) {
+		glBufferData(GL_ARRAY_BUFFER, GLT_STREAM_SIZE, NULL, GL_STREAM_DRAW);
+	}
+
+	stream->vertexArray = gltCreateVertexArray(stream->buffer, stream->buffer);
+}
+
+/*
+ * Removes the oldest fence if it has signaled, which frees the space of its
+ * frame and the drawn regions. If wait is set, this waits for the fence.
+ */
+static GLboolean
+gltStreamPollFence(GLTstream *stream, GLboolean wait)
+{
+	if (stream->fenceCount == 0) {
+		return GL_FALSE;
+	}
+
+	GLTstreamFence *fence = &stream->fences[stream->firstFence];
+	GLenum result = glClientWaitSync(fence->sync, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED) {
+		if (!wait) {
+			return GL_FALSE;
+		}
+
+		stream->stats.waitCount++;
+		do {
+			result = glClientWaitSync(fence->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(fence->sync);
+	stream->completedSerial = fence->serial;
+	stream->firstFence = (stream->firstFence + 1) % GLT_STREAM_FRAMES;
+	stream->fenceCount--;
+
+	for (int i = stream->regionCount - 1; i >= 0; i--) {
+		GLTstreamRegion *region = &stream->regions[i];
+		if (region->serial != 0 && region->serial <= stream->completedSerial) {
+			*region = stream->regions[--stream->regionCount];
+		}
+	}
+
+	return GL_TRUE;
+}
+
+/*
+ * Places a fence behind the geometry of the current frame and starts a new
+ * frame. If too many frames are in flight, this waits for the oldest one.
+ */
+static void
+gltStreamFence(GLTstream *stream)
+{
+	if (stream->fenceCount == GLT_STREAM_FRAMES) {
+		gltStreamPollFence(stream, GL_TRUE);
+	}
+
+	int index = (stream->firstFence + stream->fenceCount) % GLT_STREAM_FRAMES;
+	GLTstreamFence *fence = &stream->fences[index];
+	fence->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	fence->serial = stream->serial;
+	fence->start = stream->frameStart;
+	stream->fenceCount++;
+	stream->stats.fenceCount++;
+
+	stream->frameStart = stream->head;
+	stream->serial++;
+	stream->hasDrawn = GL_FALSE;
+}
+
+/*
+ * Returns the number of bytes from the head up to the oldest frame that the GPU
+ * may still read. If the head reached that frame, the ring is empty.
+ */
+static GLsizeiptr
+gltStreamSpace(GLTstream *stream)
+{
+	GLsizeiptr tail = stream->frameStart;
+	if (stream->fenceCount > 0) {
+		tail = stream->fences[stream->firstFence].start;
+	}
+
+	if (tail > stream->head) {
+		return tail - stream->head;
+	} else {
+		return GLT_STREAM_SIZE - stream->head + tail;
+	}
+}
+
+/*
+ * Allocates the given number of bytes at the head of the ring and returns
+ * their offset or -1 if they do not fit. This only waits for the GPU when the
+ * head runs into a frame whose fence has not signaled yet.
+ */
+static GLsizeiptr
+gltStreamAcquire(GLTstream *stream, GLsizeiptr size)
+{
+	size = GLT_STREAM_ROUND(size);
+	if (size >= GLT_STREAM_SIZE) {
+		return -1;
+	}
+
+	while (gltStreamPollFence(stream, GL_FALSE)) {
+		/* Free all frames which the GPU has finished */
+	}
+
+	GLsizeiptr skipped = 0;
+	for (;;) {
+		if (stream->fenceCount == 0 && stream->head == stream->frameStart) {
+			/* Nothing is in flight, so start over to keep the ring in one piece */
+			stream->head = 0;
+			stream->frameStart = 0;
+		}
+
+		/* The end of the ring is skipped if the region does not fit there */
+		GLsizeiptr offset = stream->head;
+		GLsizeiptr gap = 0;
+		if (offset + size > GLT_STREAM_SIZE) {
+			gap = GLT_STREAM_SIZE - offset;
+			offset = 0;
+		}
+
+		/* The space must never be used up, as a full ring looks empty */
+		if (gap + size >= gltStreamSpace(stream)) {
+			if (stream->fenceCount == 0) {
+				/* The current frame alone fills the ring */
+				gltStreamFence(stream);
+			}
+
+			gltStreamPollFence(stream, GL_TRUE);
+			continue;
+		}
+
+		GLTstreamRegion *region = NULL;
+		for (int i = 0; i < stream->regionCount; i++) {
+			GLTstreamRegion *r = &stream->regions[i];
+			if (r->start < offset + size && r->end > offset) {
+				region = r;
+				break;
+			}
+		}
+
+		if (!region) {
+			stream->head = offset + size;
+			return offset;
+		}
+
+		/* Skip the region, giving up after going around the whole ring */
+		skipped += gap + region->end - offset;
+		if (skipped >= GLT_STREAM_SIZE) {
+			return -1;
+		}
+
+		stream->head = region->end;
+	}
+}
+
+/*
+ * Frees the region at the given offset. If it was drawn, it can only be reused
+ * after the fence of the current frame has signaled.
+ */
+static void
+gltStreamRelease(GLTstream *stream, GLsizeiptr start, GLboolean isDrawn)
+{
+	if (isDrawn) {
+		stream->hasDrawn = GL_TRUE;
+	}
+
+	for (int i = stream->regionCount - 1; i >= 0; i--) {
+		GLTstreamRegion *region = &stream->regions[i];
+		if (region->serial == 0 && region->start == start) {
+			if (isDrawn) {
+				region->serial = stream->serial;
+			} else {
+				*region = stream->regions[--stream->regionCount];
+			}
+
+			return;
+		}
+	}
+}
+
+/* Keeps the head from reusing the region until it is released */
+static GLboolean
+gltStreamAddRegion(GLTstream *stream, GLsizeiptr start, GLsizeiptr size)
+{
+	if (stream->regionCount == stream->maxRegionCount) {
+		int maxRegionCount = stream->maxRegionCount ? 2 * stream->maxRegionCount : 16;
+		GLTstreamRegion *regions = (GLTstreamRegion *)gltRealloc(NULL, stream->regions,
+			stream->maxRegionCount * sizeof(*regions), maxRegionCount * sizeof(*regions));
+		if (!regions) {
+			return GL_FALSE;
+		}
+
+		stream->regions = regions;
+		stream->maxRegionCount = maxRegionCount;
+	}
+
+	GLTstreamRegion *region = &stream->regions[stream->regionCount++];
+	region->start = start;
+	region->end = start + GLT_STREAM_ROUND(size);
+	region->serial = 0;
+	return GL_TRUE;
+}
+
+/* Whether the memory lies in the mapped ring instead of on the heap */
+static GLboolean
+gltStreamContains(const GLTstream *stream, const void *ptr)
+{
+	const unsigned char *p = (const unsigned char *)ptr;
+	return stream->mapped && p >= stream->mapped && p < stream->mapped + GLT_STREAM_SIZE;
+}
+
+/*
+ * The memory of a buffer may have been allocated under another backend, so it
+ * is released according to where it lies and not to the current backend.
+ */
+static void *
+gltStreamRealloc(void *user, void *ptr, GLsizeiptr oldSize, GLsizeiptr newSize)
+{
+	GLTstream *stream = (GLTstream *)user;
+	GLboolean isInRing = gltStreamContains(stream, ptr);
+
+	/* Other backends draw the buffer themselves and may have no context */
+	GLboolean useRing = GL_FALSE;
+	if (gltCurrentBackend() == gltGLBackend()) {
+		gltStreamInit(stream);
+		useRing = stream->mapped != NULL;
+	}
+
+	if (!isInRing && !useRing) {
+		return GLT_REALLOC(ptr, newSize);
+	}
+
+	unsigned char *result = NULL;
+	if (newSize > 0) {
+		if (useRing) {
+			GLsizeiptr offset = gltStreamAcquire(stream, newSize);
+			if (offset < 0 || !gltStreamAddRegion(stream, offset, newSize)) {
+				return NULL;
+			}
+
+			result = stream->mapped + offset;
+		} else {
+			result = (unsigned char *)GLT_REALLOC(NULL, newSize);
+			if (!result) {
+				return NULL;
+			}
+		}
+
+		if (ptr) {
+			gltMoveMemory(result, ptr, oldSize < newSize ? oldSize : newSize);
+		}
+	}
+
+	if (isInRing) {
+		gltStreamRelease(stream, (unsigned char *)ptr - stream->mapped, GL_FALSE);
+	} else if (ptr) {
+		(void)GLT_REALLOC(ptr, 0);
+	}
+
+	return result;
+}
+
+GLT_API GLTallocator *
+gltStreamAllocator(void)
+{
+	static GLTallocator allocator = { gltStreamRealloc, &gltStream };
+	return &allocator;
+}
+
+GLT_API void
+gltGetStreamStats(GLTstreamStats *stats)
+{
+	*stats = gltStream.stats;
+}
+
+#ifndef GLT_TIMING_FRAMES
+#define GLT_TIMING_FRAMES 4
+#endif /* GLT_TIMING_FRAMES */
+
+enum {
+	GLT_TIMER_UPLOAD,
+	GLT_TIMER_DRAW,
+};
+
+/* The queries of one frame, which are reused once the frame was read back */
+typedef struct {
+	GLuint *queries;
+	unsigned char *kinds;
+	GLsizei queryCount;
+	GLsizei maxQueryCount;
+	unsigned long long frame;
+	GLboolean isRecorded;
+} GLTtimerFrame;
+
+typedef struct {
+	GLboolean isEnabled;
+	GLboolean isRunning;
+	GLboolean hasResult;
+	GLsizei current;
+	GLTtimerFrame frames[GLT_TIMING_FRAMES];
+	GLTgpuTime result;
+} GLTtimer;
+
+static GLTtimer gltTimer;
+
+/* Returns GL_TRUE if a query was started, which has to be ended by gltEndTimer */
+static GLboolean
+gltBeginTimer(int kind)
+{
+	GLTtimer *timer = &gltTimer;
+	if (!timer->isEnabled || timer->isRunning) {
+		return GL_FALSE;
+	}
+
+	GLTtimerFrame *frame = &timer->frames[timer->current];
+	if (frame->queryCount == frame->maxQueryCount) {
+		GLsizei maxQueryCount = frame->maxQueryCount ? 2 * frame->maxQueryCount : 16;
+		GLuint *queries = (GLuint *)GLT_REALLOC(frame->queries,
+			maxQueryCount * sizeof(*queries));
+		if (!queries) {
+			return GL_FALSE;
+		}
+
+		frame->queries = queries;
+		unsigned char *kinds = (unsigned char *)GLT_REALLOC(frame->kinds,
+			maxQueryCount * sizeof(*kinds));
+		if (!kinds) {
+			return GL_FALSE;
+		}
+
+		frame->kinds = kinds;
+		glGenQueries(maxQueryCount - frame->maxQueryCount,
+			frame->queries + frame->maxQueryCount);
+		frame->maxQueryCount = maxQueryCount;
+	}
+
+	GLsizei i = frame->queryCount++;
+	frame->kinds[i] = (unsigned char)kind;
+	glBeginQuery(GL_TIME_ELAPSED, frame->queries[i]);
+	timer->isRunning = GL_TRUE;
+	return GL_TRUE;
+}
+
+static void
+gltEndTimer(GLboolean isStarted)
+{
+	if (isStarted) {
+		glEndQuery(GL_TIME_ELAPSED);
+		gltTimer.isRunning = GL_FALSE;
+	}
+}
+
+/*
+ * Reads the results of a frame if all of them have arrived. Queries finish in
+ * order, so it is enough to check the last one. Otherwise the frame is lost.
+ */
+static void
+gltReadTimerFrame(GLTtimer *timer, GLTtimerFrame *frame)
+{
+	GLuint isAvailable = GL_TRUE;
+	if (frame->queryCount > 0) {
+		glGetQueryObjectuiv(frame->queries[frame->queryCount - 1],
+			GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+	}
+
+	if (!isAvailable) {
+		return;
+	}
+
+	GLTgpuTime time = { frame->frame, 0, 0 };
+	for (GLsizei i = 0; i < frame->queryCount; i++) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(frame->queries[i], GL_QUERY_RESULT, &elapsed);
+		if (frame->kinds[i] == GLT_TIMER_UPLOAD) {
+			time.uploadTime += elapsed;
+		} else {
+			time.drawTime += elapsed;
+		}
+	}
+
+	timer->result = time;
+	timer->hasResult = GL_TRUE;
+}
+
+static void
+gltTimerEndFrame(GLTtimer *timer, unsigned long long frameIndex)
+{
+	if (!timer->isEnabled) {
+		return;
+	}
+
+	GLTtimerFrame *frame = &timer->frames[timer->current];
+	frame->frame = frameIndex;
+	frame->isRecorded = GL_TRUE;
+
+	timer->current = (timer->current + 1) % GLT_TIMING_FRAMES;
+	frame = &timer->frames[timer->current];
+	if (frame->isRecorded) {
+		gltReadTimerFrame(timer, frame);
+	}
+
+	frame->queryCount = 0;
+	frame->isRecorded = GL_FALSE;
+}
+
+GLT_API void
+gltSetGPUTiming(GLboolean isEnabled)
+{
+	GLTtimer *timer = &gltTimer;
+	if (!isEnabled && timer->isEnabled) {
+		for (GLsizei i = 0; i < GLT_TIMING_FRAMES; i++) {
+			GLTtimerFrame *frame = &timer->frames[i];
+			if (frame->maxQueryCount > 0) {
+				glDeleteQueries(frame->maxQueryCount, frame->queries);
+			}
+
+			frame->queries = (GLuint *)GLT_REALLOC(frame->queries, 0);
+			frame->kinds = (unsigned char *)GLT_REALLOC(frame->kinds, 0);
+			frame->queryCount = 0;
+			frame->maxQueryCount = 0;
+			frame->isRecorded = GL_FALSE;
+		}
+
+		timer->current = 0;
+		timer->hasResult = GL_FALSE;
+	}
+
+	timer->isEnabled = isEnabled;
+}
+
+GLT_API GLboolean
+gltGetGPUTime(GLTgpuTime *time)
+{
+	*time = gltTimer.result;
+	return gltTimer.hasResult;
+}
+
+static void
+gltGLEndFrame(void *user)
+{
+	(void)user;
+
+	GLTstream *stream = &gltStream;
+	if (stream->hasDrawn) {
+		gltStreamFence(stream);
+	}
+
+	gltTimerEndFrame(&gltTimer, stream->stats.frameCount);
+	stream->stats.frameCount++;
+}
+
+static void
+gltAddCounters(GLTcounters *a, const GLTcounters *b)
+{
+	a->glyphCount += b->glyphCount;
+	a->quadCount += b->quadCount;
+	a->skippedQuadCount += b->skippedQuadCount;
+	a->cacheHitCount += b->cacheHitCount;
+	a->cacheMissCount += b->cacheMissCount;
+	a->rasterizedCount += b->rasterizedCount;
+	a->uploadedBytes += b->uploadedBytes;
+	a->reallocCount += b->reallocCount;
+	a->allocatedBytes += b->allocatedBytes;
+	a->drawCount += b->drawCount;
+	a->vertexBytes += b->vertexBytes;
+	a->freetypeTime += b->freetypeTime;
+}
+
+GLT_API void
+gltGetStats(GLTstats *stats)
+{
+	stats->frame = gltFrameCounters;
+	stats->total = gltTotalCounters;
+	gltAddCounters(&stats->total, &gltCounters);
+}
+
+GLT_API void
+gltResetStats(void)
+{
+	GLTcounters empty = {0};
+	gltCounters = empty;
+	gltFrameCounters = empty;
+	gltTotalCounters = empty;
+}
+
+GLT_API void
+gltEndFrame(void)
+{
+	GLTbackend *backend = gltCurrentBackend();
+	backend->endFrame(backend->user);
+	gltHasQueriedViewport = 0;
+	gltHasEndedFrame = 1;
+	gltDamage[2] = 0;
+	gltDamage[3] = 0;
+
+	GLTcounters empty = {0};
+	gltAddCounters(&gltTotalCounters, &gltCounters);
+	gltFrameCounters = gltCounters;
+	gltCounters = empty;
+
+	GLTarena *arena = &gltArena;
+	GLTarenaBlock *block = arena->blocks;
+	if (block && block->next) {
+		/* Replace the blocks with one block that fits everything */
+		while (block) {
+			GLTarenaBlock *next = block->next;
+			(void)GLT_REALLOC(block, 0);
+			block = next;
+		}
+
+		block = (GLTarenaBlock *)GLT_REALLOC(NULL,
+			GLT_ARENA_ALIGN(sizeof(GLTarenaBlock)) + arena->totalSize);
+		arena->blocks = block;
+		if (block) {
+			block->next = NULL;
+			block->size = arena->totalSize;
+		} else {
+			arena->totalSize = 0;
+		}
+	}
+
+	if (block) {
+		block->used = 0;
+		block->last = 0;
+	}
+}
+
+/*
+ * Returns a pointer for writing into the given range of the ring, which must
+ * be passed to gltStreamUnmap afterwards, or NULL if the range could not be
+ * mapped.
+ */
+static unsigned char *
+gltStreamMap(GLTstream *stream, GLsizeiptr offset, GLsizeiptr size)
+{
+	if (stream->mapped) {
+		return stream->mapped + offset;
+	}
+
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT
+		| GL_MAP_UNSYNCHRONIZED_BIT;
+	gltBindArrayBuffer(stream->buffer);
+	return (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, offset, size, access);
+}
+
+/* Returns GL_FALSE if the contents of the ring were lost while it was mapped */
+static GLboolean
+gltStreamUnmap(GLTstream *stream)
+{
+	if (stream->mapped) {
+		return GL_TRUE;
+	}
+
+	gltBindArrayBuffer(stream->buffer);
+	return glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+/*
+ * Copies the glyphs in the range [first, first + count) of the buffer into a
+ * new region of the ring. Returns the offset of the region or -1 if the ring
+ * is full or could not be written.
+ */
+static GLsizeiptr
+gltStreamCopy(GLTstream *stream, GLTbuffer *b, GLsizei first, GLsizei count)
+{
+	GLsizeiptr vertexSize = 4 * count * sizeof(*b->vertices);
+	GLsizeiptr indexSize = 6 * count * sizeof(*b->indices);
+	GLsizeiptr offset = gltStreamAcquire(stream, vertexSize + indexSize);
+	if (offset < 0) {
+		return -1;
+	}
+
+	unsigned char *data = gltStreamMap(stream, offset, vertexSize + indexSize);
+	if (!data) {
+		return -1;
+	}
+
+	gltMoveMemory(data, b->vertices + 4 * first, vertexSize);
+	gltMoveMemory(data + vertexSize, b->indices + 6 * first, indexSize);
+	if (!gltStreamUnmap(stream)) {
+		return -1;
+	}
+
+	stream->stats.bytesCopied += vertexSize + indexSize;
+	return offset;
+}
+
+/*
+ * Moves a drawn buffer, which is stored in the mapped ring, on to a new region
+ * of the same size.
+ */
+static void
+gltStreamRecycle(GLTstream *stream, GLTbuffer *b)
+{
+	gltStreamRelease(stream, (unsigned char *)b->vertices - stream->mapped, GL_TRUE);
+
+	GLsizei maxGlyphCount = b->maxGlyphCount;
+	b->vertices = NULL;
+	b->indices = NULL;
+	b->vertexCount = 0;
+	b->indexCount = 0;
+	b->maxGlyphCount = 0;
+	gltBufferResize(b, maxGlyphCount);
+}
+
+/*
+ * Draws a buffer from the ring. Buffers stored in the mapped ring are drawn in
+ * place and move on to a new region. All other buffers are copied into the
+ * ring, in several parts if they do not fit at once.
+ */
+static void
+gltDrawStreamBuffer(GLTbuffer *b)
+{
+	GLTstream *stream = &gltStream;
+	gltStreamInit(stream);
+	if (b->indexCount == 0) {
+		return;
+	}
+
+	gltBindVertexArray(stream->vertexArray);
+	if (gltStreamContains(stream, b->vertices)) {
+		GLsizeiptr vertexOffset = (unsigned char *)b->vertices - stream->mapped;
+		GLsizeiptr indexOffset = (unsigned char *)b->indices - stream->mapped;
+		glDrawElementsBaseVertex(GL_TRIANGLES, b->indexCount, GL_UNSIGNED_INT,
+			(void *)indexOffset, vertexOffset / sizeof(GLTvertex));
+		gltStreamRecycle(stream, b);
+	} else {
+		GLsizei glyphCount = b->indexCount / 6;
+		GLsizei maxPartSize = GLT_STREAM_SIZE / (2 * (GLT_VERTEX_BYTES + GLT_INDEX_BYTES));
+		for (GLsizei first = 0; first < glyphCount; first += maxPartSize) {
+			GLsizei count = glyphCount - first;
+			if (count > maxPartSize) {
+				count = maxPartSize;
+			}
+
+			GLsizeiptr vertexOffset = gltStreamCopy(stream, b, first, count);
+			if (vertexOffset < 0) {
+				break;
+			}
+
+			/* The indices of the part still count from the start of the buffer */
+			GLsizeiptr indexOffset = vertexOffset + 4 * count * sizeof(*b->vertices);
+			GLint baseVertex = vertexOffset / sizeof(GLTvertex) - 4 * first;
+			glDrawElementsBaseVertex(GL_TRIANGLES, 6 * count, GL_UNSIGNED_INT,
+				(void *)indexOffset, baseVertex);
+			gltStreamRelease(stream, vertexOffset, GL_TRUE);
+		}
+	}
+}
+
+GLT_API void
+gltBufferClip(GLTbuffer *b, float x, float y, float width, float height)
+{
+	b->hasClip = GL_TRUE;
+	b->clipMinX = x;
+	b->clipMinY = y;
+	b->clipMaxX = x + width;
+	b->clipMaxY = y + height;
+}
+
+GLT_API void
+gltBufferNoClip(GLTbuffer *b)
+{
+	b->hasClip = GL_FALSE;
+}
+
+/*
+ * Updates the high-water mark with the glyphs of the buffer. Drawing calls it
+ * before the backend, which already empties buffers in the mapped ring.
+ */
+static void
+gltBufferMark(GLTbuffer *b)
+{
+#if GLT_BUFFER_DECAY > 0
+	GLsizei glyphCount = b->vertexCount / 4;
+	/* Rounded up, so that small marks decay as well */
+	b->highWaterMark -= (b->highWaterMark + GLT_BUFFER_DECAY - 1) / GLT_BUFFER_DECAY;
+	if (glyphCount > b->highWaterMark) {
+		b->highWaterMark = glyphCount;
+	}
+#else
+	(void)b;
+#endif
+}
+
+/* Empties a buffer and shrinks it if GLT_BUFFER_DECAY is enabled */
+static void
+gltBufferEmpty(GLTbuffer *b)
+{
+	b->vertexCount = 0;
+	b->indexCount = 0;
+#if GLT_BUFFER_DECAY > 0
+	if (b->maxGlyphCount > 2 * b->highWaterMark) {
+		gltBufferResize(b, b->highWaterMark);
+	}
+#endif
+}
+
+/* Empties a drawn buffer and shrinks it if GLT_BUFFER_DECAY is enabled */
+static void
+gltBufferReset(GLTbuffer *b)
+{
+	gltBufferMark(b);
+	gltBufferEmpty(b);
+}
+
+GLT_API void
+gltDrawBuffer(GLTbuffer *b)
+{
+	gltUpdateTransform();
+	GLTdrawState state;
+	gltInitDrawState(&state, 0, 0);
+
+	GLT_COUNT(drawCount, 1);
+	GLT_COUNT(vertexBytes, b->vertexCount * sizeof(GLTvertex));
+
+	GLT_ZONE_BEGIN("draw");
+	gltBufferMark(b);
+	GLTbackend *backend = gltCurrentBackend();
+	backend->drawBuffer(backend->user, b, &state);
+	gltBufferEmpty(b);
+	GLT_ZONE_END("draw");
+}
+
+static void
+gltBatchInit(GLTbatch *batch, GLTstream *stream)
+{
+	if (batch->isInitialized) {
+		return;
+	}
+
+	batch->isInitialized = GL_TRUE;
+
+#ifdef GL_DRAW_INDIRECT_BUFFER
+	batch->hasMultiDraw = gltHasVersion(4, 3) || (gltHasExtension("GL_ARB_multi_draw_indirect")
+		&& gltHasExtension("GL_ARB_base_instance"));
+#endif /* GL_DRAW_INDIRECT_BUFFER */
+
+	/*
+	 * The draw index is an instanced attribute, so that the base instance of
+	 * each command selects its parameters. Without base instances, it is
+	 * always zero and the drawBase uniform selects them.
+	 */
+	GLuint drawIndices[GLT_BATCH_SIZE];
+	for (GLuint i = 0; i < GLT_BATCH_SIZE; i++) {
+		drawIndices[i] = i;
+	}
+
+	glGenBuffers(1, &batch->drawIndexBuffer);
+	gltBindArrayBuffer(batch->drawIndexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(drawIndices), drawIndices, GL_STATIC_DRAW);
+
+	batch->vertexArray = gltCreateVertexArray(stream->buffer, stream->buffer);
+	gltBindArrayBuffer(batch->drawIndexBuffer);
+	glEnableVertexAttribArray(3);
+	glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), NULL);
+	glVertexAttribDivisor(3, 1);
+
+	glGenBuffers(1, &batch->uniformBuffer);
+	glGenBuffers(1, &batch->indirectBuffer);
+}
+
+/*
+ * Draws the parts of the batch. Copied parts are read from the region at the
+ * given offset, which stores their vertices first and then their indices.
+ */
+static void
+gltBatchSubmit(GLTbatch *batch, const GLTdrawItem *items, GLsizei partCount,
+	GLsizei paramCount, GLsizeiptr offset, GLsizei glyphCount)
+{
+	GLTstream *stream = &gltStream;
+	for (GLsizei i = 0; i < partCount; i++) {
+		GLTbatchPart *part = &batch->parts[i];
+		GLTbuffer *b = items[part->item].buffer;
+		GLsizeiptr vertexOffset, indexOffset;
+		if (part->isInPlace) {
+			vertexOffset = (unsigned char *)b->vertices - stream->mapped;
+			indexOffset = (unsigned char *)b->indices - stream->mapped;
+		} else {
+			vertexOffset = offset + part->glyphOffset * GLT_VERTEX_BYTES;
+			indexOffset = offset + glyphCount * GLT_VERTEX_BYTES
+				+ part->glyphOffset * GLT_INDEX_BYTES;
+		}
+
+		/* The indices of a part still count from the start of its buffer */
+		GLTdrawCommand *command = &batch->commands[i];
+		command->count = 6 * part->count;
+		command->instanceCount = 1;
+		command->firstIndex = indexOffset / sizeof(GLuint);
+		command->baseVertex = vertexOffset / sizeof(GLTvertex) - 4 * part->first;
+		command->baseInstance = part->param;
+	}
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, batch->uniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(batch->params), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, paramCount * sizeof(*batch->params),
+		batch->params);
+
+#ifdef GL_DRAW_INDIRECT_BUFFER
+	if (batch->hasMultiDraw) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch->indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, partCount * sizeof(*batch->commands),
+			batch->commands, GL_STREAM_DRAW);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, partCount, 0);
+		return;
+	}
+#endif /* GL_DRAW_INDIRECT_BUFFER */
+
+	for (GLsizei i = 0; i < partCount; i++) {
+		GLTdrawCommand *command = &batch->commands[i];
+		if (batch->drawBase != command->baseInstance) {
+			batch->drawBase = command->baseInstance;
+			glUniform1ui(batch->drawBaseLocation, batch->drawBase);
+		}
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, command->count, GL_UNSIGNED_INT,
+			(void *)((GLsizeiptr)command->firstIndex * sizeof(GLuint)),
+			command->baseVertex);
+	}
+}
+
+static void
+gltGLDrawBuffers(void *user, const GLTdrawItem *items, GLsizei count,
+	const GLTdrawState *state)
+{
+	(void)user;
+
+	GLTstream *stream = &gltStream;
+	GLTbatch *batch = &gltBatch;
+	gltStreamInit(stream);
+	gltBatchInit(batch, stream);
+	GLboolean isTimed = gltBeginTimer(GLT_TIMER_DRAW);
+
+	GLTprogram *p = gltHasEffect(&state->effect) ? &gltBatchEffectProgram : &gltBatchProgram;
+	GLuint program = gltFinishProgram(p);
+	gltEnableBlend();
+	gltBindProgram(program);
+	if (program != batch->program) {
+		batch->program = program;
+		batch->drawBaseLocation = p->locations[GLT_LOCATION_DRAW_BASE];
+		glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Draws"), 0);
+		glUniform1ui(batch->drawBaseLocation, batch->drawBase);
+	}
+
+	gltBindTexture(state->texture);
+	gltBindVertexArray(batch->vertexArray);
+	gltUseEffect(p, &state->effect);
+
+	GLsizei maxGlyphCount = GLT_STREAM_SIZE / (2 * (GLT_VERTEX_BYTES + GLT_INDEX_BYTES));
+	GLsizei item = 0;
+	GLsizei first = 0;
+	while (item < count) {
+		/* Collect parts until the commands or the copied glyphs are full */
+		GLsizei partCount = 0;
+		GLsizei paramCount = 0;
+		GLsizei glyphCount = 0;
+		while (item < count && partCount < GLT_BATCH_SIZE) {
+			GLTbuffer *b = items[item].buffer;
+			GLsizei itemGlyphCount = b->indexCount / 6;
+			if (first >= itemGlyphCount) {
+				item++;
+				first = 0;
+				continue;
+			}
+
+			GLboolean isInPlace = gltStreamContains(stream, b->vertices);
+			GLsizei partGlyphCount = itemGlyphCount - first;
+			if (!isInPlace && partGlyphCount > maxGlyphCount - glyphCount) {
+				partGlyphCount = maxGlyphCount - glyphCount;
+				if (partGlyphCount == 0) {
+					break;
+				}
+			}
+
+			if (first == 0 || paramCount == 0) {
+				const GLTdrawItem *drawItem = &items[item];
+				GLTdrawParams *params = &batch->params[paramCount++];
+				const float *transform = drawItem->transform ? drawItem->transform
+					: state->transform;
+				for (int i = 0; i < 16; i++) {
+					params->transform[i] = transform[i];
+				}
+
+				if (drawItem->color) {
+					params->color[0] = (drawItem->color >> 24) / 255.f;
+					params->color[1] = ((drawItem->color >> 16) & 0xff) / 255.f;
+					params->color[2] = ((drawItem->color >> 8) & 0xff) / 255.f;
+					params->color[3] = (drawItem->color & 0xff) / 255.f;
+				} else {
+					for (int i = 0; i < 4; i++) {
+						params->color[i] = state->color[i];
+					}
+				}
+
+				params->offset[0] = drawItem->x;
+				params->offset[1] = drawItem->y;
+				params->offset[2] = 0;
+				params->offset[3] = 0;
+			}
+
+			GLTbatchPart *part = &batch->parts[partCount++];
+			part->item = item;
+			part->first = first;
+			part->count = partGlyphCount;
+			part->param = paramCount - 1;
+			part->glyphOffset = glyphCount;
+			part->isInPlace = isInPlace;
+			if (!isInPlace) {
+				glyphCount += partGlyphCount;
+			}
+
+			first += partGlyphCount;
+		}
+
+		if (partCount == 0) {
+			break;
+		}
+
+		GLsizeiptr offset = -1;
+		if (glyphCount > 0) {
+			GLsizeiptr vertexSize = glyphCount * GLT_VERTEX_BYTES;
+			GLsizeiptr size = glyphCount * (GLT_VERTEX_BYTES + GLT_INDEX_BYTES);
+			offset = gltStreamAcquire(stream, size);
+			if (offset < 0) {
+				break;
+			}
+
+			unsigned char *data = gltStreamMap(stream, offset, size);
+			if (!data) {
+				break;
+			}
+
+			for (GLsizei i = 0; i < partCount; i++) {
+				GLTbatchPart *part = &batch->parts[i];
+				GLTbuffer *b = items[part->item].buffer;
+				if (!part->isInPlace) {
+					gltMoveMemory(data + part->glyphOffset * GLT_VERTEX_BYTES,
+						b->vertices + 4 * part->first, part->count * GLT_VERTEX_BYTES);
+					gltMoveMemory(data + vertexSize + part->glyphOffset * GLT_INDEX_BYTES,
+						b->indices + 6 * part->first, part->count * GLT_INDEX_BYTES);
+				}
+			}
+
+			if (!gltStreamUnmap(stream)) {
+				break;
+			}
+
+			stream->stats.bytesCopied += size;
+		}
+
+		gltBatchSubmit(batch, items, partCount, paramCount, offset, glyphCount);
+
+		if (offset >= 0) {
+			gltStreamRelease(stream, offset, GL_TRUE);
+		}
+
+		for (GLsizei i = 0; i < partCount; i++) {
+			GLTbatchPart *part = &batch->parts[i];
+			if (part->isInPlace) {
+				gltStreamRecycle(stream, items[part->item].buffer);
+			}
+		}
+	}
+
+	gltEndTimer(isTimed);
+}
+
+GLT_API void
+gltDrawBuffers(const GLTdrawItem *items, GLsizei count)
+{
+	gltUpdateTransform();
+	GLTdrawState state;
+	gltInitDrawState(&state, 0, 0);
+
+	GLT_COUNT(drawCount, 1);
+	for (GLsizei i = 0; i < count; i++) {
+		GLT_COUNT(vertexBytes, items[i].buffer->vertexCount * sizeof(GLTvertex));
+		gltBufferMark(items[i].buffer);
+	}
+
+	GLT_ZONE_BEGIN("draw");
+	GLTbackend *backend = gltCurrentBackend();
+	backend->drawBuffers(backend->user, items, count, &state);
+	for (GLsizei i = 0; i < count; i++) {
+		gltBufferEmpty(items[i].buffer);
+	}
+
+	GLT_ZONE_END("draw");
+}
+
+/*
+ * Creates the texture atlas if necessary and loads the glyphs of the current
+ * font into it if it was not used before. Returns the glyphs of the current
+ * font or NULL if no font is bound.
+ */
+static GLTglyph *
+gltUpdateCache(void)
+{
+	if (gltCurrentFont == 0) {
+		return NULL;
+	}
+
+	GLTcache *cache = &gltGlobalCache;
+	if (!cache->pixels && (gltAtlasStorage & GLT_ATLAS_CPU)) {
+		cache->pixels = (unsigned char *)gltRealloc(NULL, NULL, 0, 1024 * 1024);
+		if (!cache->pixels) {
+			return NULL;
+		}
+
+		for (long i = 0; i < 1024 * 1024; i++) {
+			cache->pixels[i] = 0;
+		}
+	}
+
+	GLTbackend *backend = gltCurrentBackend();
+	gltRestoreAtlas();
+	if (!cache->textureAtlas && (gltAtlasStorage & GLT_ATLAS_GPU)) {
+		cache->textureAtlas = backend->createTexture(backend->user, 1024, 1024);
+	}
+
+	GLTglyph *glyphs = cache->glyphs[gltCurrentFont];
+	if (glyphs) {
+		GLT_COUNT(cacheHitCount, 1);
+		return glyphs;
+	}
+
+	GLT_COUNT(cacheMissCount, 1);
+
+	glyphs = (GLTglyph *)gltRealloc(NULL, NULL, 0, 128 * sizeof(*glyphs));
+	if (!glyphs) {
+		return NULL;
+	}
+
+	for (int c = 0; c < 128; c++) {
+		GLTglyph empty = {0};
+		glyphs[c] = empty;
+	}
+
+	cache->glyphs[gltCurrentFont] = glyphs;
+
+	GLT_ZONE_BEGIN("rasterize");
+	FT_Face face = gltFonts[gltCurrentFont];
+	GLboolean isFull = GL_FALSE;
+	for (int c = 32; c < 127; c++) {
+		unsigned long long start = GLT_STATS_TIME();
+		FT_Error error = FT_Load_Char(face, c, FT_LOAD_RENDER);
+		GLT_COUNT(freetypeTime, GLT_STATS_TIME() - start);
+		if (error != 0) {
+			continue;
+		}
+
+		GLT_COUNT(rasterizedCount, 1);
+
+		FT_GlyphSlot glyphSlot = face->glyph;
+		FT_Bitmap bitmap = glyphSlot->bitmap;
+
+		/* The padding stays empty, so effects never sample a neighbor */
+		int padding = gltGlyphPadding;
+		if (cache->currentOffsetX + bitmap.width + 2 * padding > 1024) {
+			cache->currentOffsetX = 0;
+			cache->currentOffsetY += cache->currentRowHeight;
+			cache->currentRowHeight = 0;
+		}
+
+		GLTglyph *glyph = glyphs + c;
+		glyph->codepoint = c;
+		glyph->advance = glyphSlot->advance.x / 64.;
+		if (cache->currentOffsetY + bitmap.rows + 2 * padding > 1024) {
+			isFull = GL_TRUE;
+			continue;
+		}
+
+		float width = bitmap.width;
+		float height = bitmap.rows;
+		float x = cache->currentOffsetX + padding;
+		float y = cache->currentOffsetY + padding;
+
+		glyph->xMin = x;
+		glyph->yMin = y;
+		glyph->xMax = glyph->xMin + width;
+		glyph->yMax = glyph->yMin + height;
+		glyph->bearingX = glyphSlot->bitmap_left;
+		glyph->bearingY = glyphSlot->bitmap_top - height;
+
+		if (glyph->bearingY + height > cache->ascent[gltCurrentFont]) {
+			cache->ascent[gltCurrentFont] = glyph->bearingY + height;
+		}
+
+		if (glyph->bearingY < cache->descent[gltCurrentFont]) {
+			cache->descent[gltCurrentFont] = glyph->bearingY;
+		}
+
+		if (glyph->bearingX < cache->minBearingX[gltCurrentFont]) {
+			cache->minBearingX[gltCurrentFont] = glyph->bearingX;
+		}
+
+		if (cache->textureAtlas) {
+			GLT_COUNT(uploadedBytes, bitmap.width * bitmap.rows);
+			GLT_ZONE_BEGIN("upload");
+			backend->updateTexture(backend->user, cache->textureAtlas,
+				x, y, width, height, bitmap.pitch, bitmap.buffer);
+			GLT_ZONE_END("upload");
+		}
+
+		if (cache->pixels) {
+			for (unsigned int row = 0; row < bitmap.rows; row++) {
+				unsigned char *src = bitmap.buffer + row * bitmap.pitch;
+				unsigned char *dst = cache->pixels + ((int)y + row) * 1024 + (int)x;
+				for (unsigned int col = 0; col < bitmap.width; col++) {
+					dst[col] = src[col];
+				}
+			}
+		}
+
+		cache->currentOffsetX += bitmap.width + 2 * padding;
+		if (bitmap.rows + 2 * padding > cache->currentRowHeight) {
+			cache->currentRowHeight = bitmap.rows + 2 * padding;
+		}
+	}
+
+	if (isFull) {
+		fprintf(stderr, "Texture atlas is full\n");
+	}
+
+	GLT_ZONE_END("rasterize");
+	return glyphs;
+}
+
+/*
+ * Appends the quad of a single glyph with its origin at (x, y). The caller
+ * must have reserved enough space in the buffer.
+ */
+static void
+gltEmitGlyph(GLTbuffer *b, GLTglyph *glyph, float x, float y)
+{
+	/* The quad includes the padding, which the effects draw into */
+	float padding = gltGlyphPadding;
+	float xMin = glyph->xMin - padding;
+	float yMin = glyph->yMin - padding;
+	float xMax = glyph->xMax + padding;
+	float yMax = glyph->yMax + padding;
+	float width = xMax - xMin;
+	float height = yMax - yMin;
+
+	GLTvertex *vertex = b->vertices + b->vertexCount;
+	unsigned int *index = b->indices + b->indexCount;
+	float xPos = x + glyph->bearingX - padding;
+	float yPos = y + glyph->bearingY - padding;
+
+	vertex[0].x = xPos;
+	vertex[0].y = yPos;
+	vertex[0].u = xMin / 1024.;
+	vertex[0].v = yMax / 1024.;
+
+	vertex[1].x = xPos + width;
+	vertex[1].y = yPos;
+	vertex[1].u = xMax / 1024.;
+	vertex[1].v = yMax / 1024.;
+
+	vertex[2].x = xPos;
+	vertex[2].y = yPos + height;
+	vertex[2].u = xMin / 1024.;
+	vertex[2].v = yMin / 1024.;
+
+	vertex[3].x = xPos + width;
+	vertex[3].y = yPos + height;
+	vertex[3].u = xMax / 1024.;
+	vertex[3].v = yMin / 1024.;
+
+	for (int i = 0; i < 4; i++) {
+		vertex[i].color[0] = gltVertexColor[0];
+		vertex[i].color[1] = gltVertexColor[1];
+		vertex[i].color[2] = gltVertexColor[2];
+		vertex[i].color[3] = gltVertexColor[3];
+	}
+
+	*index++ = b->vertexCount + 0;
+	*index++ = b->vertexCount + 1;
+	*index++ = b->vertexCount + 3;
+
+	*index++ = b->vertexCount + 0;
+	*index++ = b->vertexCount + 3;
+	*index++ = b->vertexCount + 2;
+
+	b->vertexCount += 4;
+	b->indexCount += 6;
+}
+
+/*
+ * Removes the last quad of the buffer if it lies outside of the clip
+ * rectangle or trims it and its texture coordinates to the rectangle.
+ */
+static void
+gltClipGlyph(GLTbuffer *b)
+{
+	GLTvertex *vertex = b->vertices + b->vertexCount - 4;
+	float x0 = vertex[0].x;
+	float y0 = vertex[0].y;
+	float x1 = vertex[3].x;
+	float y1 = vertex[3].y;
+
+	if (x1 <= b->clipMinX || x0 >= b->clipMaxX || y1 <= b->clipMinY || y0 >= b->clipMaxY) {
+		b->vertexCount -= 4;
+		b->indexCount -= 6;
+		return;
+	}
+
+	if (x0 < b->clipMinX || x1 > b->clipMaxX) {
+		float u0 = vertex[0].u;
+		float du = (vertex[3].u - u0) / (x1 - x0);
+		float newX0 = x0 < b->clipMinX ? b->clipMinX : x0;
+		float newX1 = x1 > b->clipMaxX ? b->clipMaxX : x1;
+		float newU0 = u0 + (newX0 - x0) * du;
+		float newU1 = u0 + (newX1 - x0) * du;
+
+		vertex[0].x = vertex[2].x = newX0;
+		vertex[1].x = vertex[3].x = newX1;
+		vertex[0].u = vertex[2].u = newU0;
+		vertex[1].u = vertex[3].u = newU1;
+	}
+
+	if (y0 < b->clipMinY || y1 > b->clipMaxY) {
+		float v0 = vertex[0].v;
+		float dv = (vertex[3].v - v0) / (y1 - y0);
+		float newY0 = y0 < b->clipMinY ? b->clipMinY : y0;
+		float newY1 = y1 > b->clipMaxY ? b->clipMaxY : y1;
+		float newV0 = v0 + (newY0 - y0) * dv;
+		float newV1 = v0 + (newY1 - y0) * dv;
+
+		vertex[0].y = vertex[1].y = newY0;
+		vertex[2].y = vertex[3].y = newY1;
+		vertex[0].v = vertex[1].v = newV0;
+		vertex[2].v = vertex[3].v = newV1;
+	}
+}
+
+/*
+ * Emits the glyphs of the text without updating the cache or reserving space
+ * in the buffer.
+ */
+static float
+gltPushGlyphs(GLTbuffer *b, GLTglyph *glyphs, float x, float y, char *text, GLsizei count)
+{
+	GLT_COUNT(glyphCount, count);
+	if (b->hasClip) {
+		GLTcache *cache = &gltGlobalCache;
+		if (y + cache->ascent[gltCurrentFont] + gltGlyphPadding <= b->clipMinY
+				|| y + cache->descent[gltCurrentFont] - gltGlyphPadding >= b->clipMaxY) {
+			GLT_COUNT(skippedQuadCount, count);
+			return x;
+		}
+	}
+
+	GLsizei emittedCount = b->vertexCount / 4;
+	GLsizei glyphCount = count;
+	char *at = text;
+	float padding = gltGlyphPadding;
+	float minBearingX = gltGlobalCache.minBearingX[gltCurrentFont];
+	while (count-- > 0) {
+		unsigned char c = *at++;
+		if (c >= 128) {
+			continue;
+		}
+
+		GLTglyph *glyph = &glyphs[c];
+		if (b->hasClip) {
+			/* The pen only moves right, so no later glyph reaches into the rectangle */
+			if (x + minBearingX - padding >= b->clipMaxX) {
+				break;
+			}
+
+			float xMax = x + glyph->bearingX + glyph->xMax - glyph->xMin + padding;
+			if (xMax <= b->clipMinX) {
+				x += glyph->advance;
+				continue;
+			}
+
+			gltEmitGlyph(b, glyph, x, y);
+			gltClipGlyph(b);
+		} else {
+			gltEmitGlyph(b, glyph, x, y);
+		}
+
+		x += glyph->advance;
+	}
+
+	emittedCount = b->vertexCount / 4 - emittedCount;
+	GLT_COUNT(quadCount, emittedCount);
+	GLT_COUNT(skippedQuadCount, glyphCount - emittedCount);
+	return x;
+}
+
+GLT_API float
+gltPushnText(GLTbuffer *b, float x, float y, char *text, GLsizei count)
+{
+	GLT_ZONE_BEGIN("push");
+	GLTglyph *glyphs = gltUpdateCache();
+	if (glyphs && gltBufferReserve(b, b->vertexCount / 4 + count)) {
+		x = gltPushGlyphs(b, glyphs, x, y, text, count);
+	}
+
+	GLT_ZONE_END("push");
+	return x;
+}
+
+static GLsizei
+gltTextLength(char *text)
+{
+	GLsizei length = 0;
+	while (text[length] != 0) {
+		length++;
+	}
+
+	return length;
+}
+
+GLT_API float
+gltPushText(GLTbuffer *b, float x, float y, char *text)
+{
+	GLsizei length = gltTextLength(text);
+	return gltPushnText(b, x, y, text, length);
+}
+
+GLT_API void
+gltListLayer(GLTlist *l, int layer)
+{
+	l->layer = layer;
+}
+
+/*
+ * Returns the index of the current transform in the list, which is added if
+ * it is not in the list yet, or -1 if the allocation failed. The most recent
+ * transforms are the most likely matches.
+ */
+static GLsizei
+gltListTransform(GLTlist *l)
+{
+	for (GLsizei index = l->transformCount - 1; index >= 0; index--) {
+		float *transform = l->transforms + 16 * index;
+		int i = 0;
+		while (i < 16 && transform[i] == gltTransform[i]) {
+			i++;
+		}
+
+		if (i == 16) {
+			return index;
+		}
+	}
+
+	if (l->transformCount == l->maxTransformCount) {
+		GLsizei maxTransformCount = l->maxTransformCount ? 2 * l->maxTransformCount : 8;
+		float *transforms = (float *)gltRealloc(l->allocator, l->transforms,
+			16 * l->maxTransformCount * sizeof(float), 16 * maxTransformCount * sizeof(float));
+		if (!transforms) {
+			return -1;
+		}
+
+		l->transforms = transforms;
+		l->maxTransformCount = maxTransformCount;
+	}
+
+	float *transform = l->transforms + 16 * l->transformCount;
+	for (int i = 0; i < 16; i++) {
+		transform[i] = gltTransform[i];
+	}
+
+	return l->transformCount++;
+}
+
+/* Returns the index of the current effect in the list or -1 on failure */
+static GLsizei
+gltListEffect(GLTlist *l)
+{
+	for (GLsizei index = l->effectCount - 1; index >= 0; index--) {
+		if (gltEffectEquals(&l->effects[index], &gltEffect)) {
+			return index;
+		}
+	}
+
+	if (l->effectCount == l->maxEffectCount) {
+		GLsizei maxEffectCount = l->maxEffectCount ? 2 * l->maxEffectCount : 4;
+		GLTeffect *effects = (GLTeffect *)gltRealloc(l->allocator, l->effects,
+			l->maxEffectCount * sizeof(*effects), maxEffectCount * sizeof(*effects));
+		if (!effects) {
+			return -1;
+		}
+
+		l->effects = effects;
+		l->maxEffectCount = maxEffectCount;
+	}
+
+	l->effects[l->effectCount] = gltEffect;
+	return l->effectCount++;
+}
+
+/* The commands are followed by the same number of entries for sorting */
+static GLboolean
+gltListReserve(GLTlist *l)
+{
+	if (l->commandCount < l->maxCommandCount) {
+		return GL_TRUE;
+	}
+
+	GLsizei maxCommandCount = l->maxCommandCount ? 2 * l->maxCommandCount : 64;
+	GLTlistCommand *commands = (GLTlistCommand *)gltRealloc(l->allocator, l->commands,
+		2 * l->maxCommandCount * sizeof(*commands), 2 * maxCommandCount * sizeof(*commands));
+	if (!commands) {
+		return GL_FALSE;
+	}
+
+	l->commands = commands;
+	l->maxCommandCount = maxCommandCount;
+	return GL_TRUE;
+}
+
+GLT_API float
+gltListPushText(GLTlist *l, float x, float y, char *text)
+{
+	GLsizei length = gltTextLength(text);
+	return gltListPushnText(l, x, y, text, length);
+}
+
+GLT_API float
+gltListPushnText(GLTlist *l, float x, float y, char *text, GLsizei count)
+{
+	gltUpdateTransform();
+	GLsizei transform = gltListTransform(l);
+	GLsizei effect = transform < 0 ? -1 : gltListEffect(l);
+	if (effect < 0 || !gltListReserve(l)) {
+		return x;
+	}
+
+	/* The color uniform is the same for the whole list, so move it into the vertices */
+	GLubyte vertexColor[4];
+	for (int i = 0; i < 4; i++) {
+		vertexColor[i] = gltVertexColor[i];
+		gltVertexColor[i] = gltColorByte(vertexColor[i] * gltColor[i]);
+	}
+
+	GLTbuffer *b = &l->geometry;
+	GLsizei first = b->vertexCount / 4;
+	float result = gltPushnText(b, x, y, text, count);
+	GLsizei glyphCount = b->vertexCount / 4 - first;
+
+	for (int i = 0; i < 4; i++) {
+		gltVertexColor[i] = vertexColor[i];
+	}
+
+	if (glyphCount == 0) {
+		return result;
+	}
+
+	GLuint atlas = gltGlobalCache.textureAtlas;
+	if (l->commandCount > 0) {
+		GLTlistCommand *last = &l->commands[l->commandCount - 1];
+		if (last->layer == l->layer && last->atlas == atlas && last->transform == transform
+				&& last->effect == effect && last->first + last->count == first) {
+			last->count += glyphCount;
+			return result;
+		}
+	}
+
+	GLTlistCommand *command = &l->commands[l->commandCount++];
+	command->layer = l->layer;
+	command->atlas = atlas;
+	command->transform = transform;
+	command->effect = effect;
+	command->first = first;
+	command->count = glyphCount;
+	return result;
+}
+
+static GLboolean
+gltListCommandLess(const GLTlistCommand *a, const GLTlistCommand *b)
+{
+	if (a->layer != b->layer) {
+		return a->layer < b->layer;
+	}
+
+	if (a->atlas != b->atlas) {
+		return a->atlas < b->atlas;
+	}
+
+	if (a->transform != b->transform) {
+		return a->transform < b->transform;
+	}
+
+	return a->effect < b->effect;
+}
+
+/* Stable merge sort, which returns the array which holds the sorted commands */
+static GLTlistCommand *
+gltListSort(GLTlistCommand *commands, GLTlistCommand *scratch, GLsizei count)
+{
+	GLTlistCommand *src = commands;
+	GLTlistCommand *dst = scratch;
+	for (GLsizei width = 1; width < count; width *= 2) {
+		for (GLsizei start = 0; start < count; start += 2 * width) {
+			GLsizei middle = start + width < count ? start + width : count;
+			GLsizei end = start + 2 * width < count ? start + 2 * width : count;
+			GLsizei i = start;
+			GLsizei j = middle;
+			for (GLsizei k = start; k < end; k++) {
+				if (i < middle && (j == end || !gltListCommandLess(&src[j], &src[i]))) {
+					dst[k] = src[i++];
+				} else {
+					dst[k] = src[j++];
+				}
+			}
+		}
+
+		GLTlistCommand *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	return src;
+}
+
+GLT_API void
+gltDrawList(GLTlist *l)
+{
+	GLTbuffer *b = &l->geometry;
+	GLTbuffer *run = &l->run;
+	run->allocator = b->allocator;
+	if (l->commandCount == 0) {
+		gltBufferReset(b);
+		return;
+	}
+
+	GLT_ZONE_BEGIN("draw");
+	GLTlistCommand *commands = gltListSort(l->commands,
+		l->commands + l->maxCommandCount, l->commandCount);
+
+	/* The colors are stored in the vertices, the transform and effect change per run */
+	GLTbackend *backend = gltCurrentBackend();
+	GLTdrawState state;
+	gltInitDrawState(&state, 0, 0);
+	for (int i = 0; i < 4; i++) {
+		state.color[i] = 1;
+	}
+
+	GLsizei start = 0;
+	while (start < l->commandCount) {
+		GLsizei end = start + 1;
+		GLsizei glyphCount = commands[start].count;
+		while (end < l->commandCount && commands[end].atlas == commands[start].atlas
+				&& commands[end].transform == commands[start].transform
+				&& commands[end].effect == commands[start].effect) {
+			glyphCount += commands[end].count;
+			end++;
+		}
+
+		if (gltBufferReserve(run, glyphCount)) {
+			for (GLsizei i = start; i < end; i++) {
+				GLTlistCommand *command = &commands[i];
+				GLsizei shift = 4 * (run->vertexCount / 4 - command->first);
+				gltMoveMemory(run->vertices + run->vertexCount,
+					b->vertices + 4 * command->first, command->count * GLT_VERTEX_BYTES);
+				for (GLsizei j = 0; j < 6 * command->count; j++) {
+					run->indices[run->indexCount + j] = b->indices[6 * command->first + j] + shift;
+				}
+
+				run->vertexCount += 4 * command->count;
+				run->indexCount += 6 * command->count;
+			}
+
+			const float *transform = l->transforms + 16 * commands[start].transform;
+			for (int i = 0; i < 16; i++) {
+				state.transform[i] = transform[i];
+			}
+
+			state.texture = commands[start].atlas;
+			state.effect = l->effects[commands[start].effect];
+			GLT_COUNT(drawCount, 1);
+			GLT_COUNT(vertexBytes, run->vertexCount * sizeof(GLTvertex));
+			gltBufferMark(run);
+			backend->drawBuffer(backend->user, run, &state);
+			gltBufferEmpty(run);
+		}
+
+		start = end;
+	}
+
+	gltBufferReset(b);
+	l->commandCount = 0;
+	l->transformCount = 0;
+	l->effectCount = 0;
+	GLT_ZONE_END("draw");
+}
+
+GLT_API void
+gltListFree(GLTlist *l)
+{
+	gltBufferFree(&l->geometry);
+	gltBufferFree(&l->run);
+	l->commands = (GLTlistCommand *)gltRealloc(l->allocator, l->commands,
+		2 * l->maxCommandCount * sizeof(*l->commands), 0);
+	l->transforms = (float *)gltRealloc(l->allocator, l->transforms,
+		16 * l->maxTransformCount * sizeof(float), 0);
+	l->effects = (GLTeffect *)gltRealloc(l->allocator, l->effects,
+		l->maxEffectCount * sizeof(*l->effects), 0);
+	l->commandCount = 0;
+	l->maxCommandCount = 0;
+	l->transformCount = 0;
+	l->maxTransformCount = 0;
+	l->effectCount = 0;
+	l->maxEffectCount = 0;
+}
+
+static GLfloat gltLabelView[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+static GLfloat gltLabelProjection[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+static GLfloat gltLabelScale;
+
+static GLboolean
+gltLabelsReserve(GLTlabels *l, GLsizei glyphCount)
+{
+	if (glyphCount <= l->maxGlyphCount) {
+		return GL_TRUE;
+	}
+
+	GLsizei maxGlyphCount = l->maxGlyphCount;
+	if (maxGlyphCount == 0) {
+		maxGlyphCount = 256;
+	}
+
+	while (maxGlyphCount < glyphCount) {
+		maxGlyphCount *= 2;
+	}
+
+	GLTlabelVertex *vertices = (GLTlabelVertex *)gltRealloc(l->allocator, l->vertices,
+		4 * l->maxGlyphCount * sizeof(*vertices), 4 * maxGlyphCount * sizeof(*vertices));
+	if (!vertices) {
+		return GL_FALSE;
+	}
+
+	l->vertices = vertices;
+	l->maxGlyphCount = maxGlyphCount;
+	return GL_TRUE;
+}
+
+GLT_API float
+gltPushLabel(GLTlabels *l, float x, float y, float z,
+	float offsetX, float offsetY, char *text)
+{
+	GLsizei length = gltTextLength(text);
+	return gltPushnLabel(l, x, y, z, offsetX, offsetY, text, length);
+}
+
+GLT_API float
+gltPushnLabel(GLTlabels *l, float x, float y, float z,
+	float offsetX, float offsetY, char *text, GLsizei count)
+{
+	GLT_ZONE_BEGIN("push");
+	GLTglyph *glyphs = gltUpdateCache();
+	if (!glyphs || !gltLabelsReserve(l, l->vertexCount / 4 + count)) {
+		GLT_ZONE_END("push");
+		return offsetX;
+	}
+
+	GLT_COUNT(glyphCount, count);
+	GLsizei emittedCount = l->vertexCount / 4;
+	for (GLsizei i = 0; i < count; i++) {
+		unsigned char c = text[i];
+		if (c >= 128) {
+			continue;
+		}
+
+		/* Spaces have no quad, which saves a lot with many short labels */
+		GLTglyph *glyph = &glyphs[c];
+		if (glyph->xMax > glyph->xMin && glyph->yMax > glyph->yMin) {
+			float padding = gltGlyphPadding;
+			float x0 = offsetX + glyph->bearingX - padding;
+			float y0 = offsetY + glyph->bearingY - padding;
+			float x1 = x0 + (glyph->xMax - glyph->xMin) + 2 * padding;
+			float y1 = y0 + (glyph->yMax - glyph->yMin) + 2 * padding;
+			float u0 = glyph->xMin - padding;
+			float v0 = glyph->yMin - padding;
+			float u1 = glyph->xMax + padding;
+			float v1 = glyph->yMax + padding;
+			float corners[4][4] = {
+				{ x0, y0, u0, v1 },
+				{ x1, y0, u1, v1 },
+				{ x0, y1, u0, v0 },
+				{ x1, y1, u1, v0 },
+			};
+
+			GLTlabelVertex *vertex = l->vertices + l->vertexCount;
+			for (int j = 0; j < 4; j++) {
+				vertex[j].anchor[0] = x;
+				vertex[j].anchor[1] = y;
+				vertex[j].anchor[2] = z;
+				vertex[j].x = corners[j][0];
+				vertex[j].y = corners[j][1];
+				vertex[j].u = corners[j][2] / 1024.;
+				vertex[j].v = corners[j][3] / 1024.;
+				vertex[j].color[0] = gltVertexColor[0];
+				vertex[j].color[1] = gltVertexColor[1];
+				vertex[j].color[2] = gltVertexColor[2];
+				vertex[j].color[3] = gltVertexColor[3];
+			}
+
+			l->vertexCount += 4;
+		}
+
+		offsetX += glyph->advance;
+	}
+
+	emittedCount = l->vertexCount / 4 - emittedCount;
+	GLT_COUNT(quadCount, emittedCount);
+	GLT_COUNT(skippedQuadCount, count - emittedCount);
+	GLT_ZONE_END("push");
+	return offsetX;
+}
+
+GLT_API void
+gltSetLabelCamera(float *view, float *projection)
+{
+	for (int i = 0; i < 16; i++) {
+		gltLabelView[i] = view[i];
+		gltLabelProjection[i] = projection[i];
+	}
+}
+
+GLT_API void
+gltSetLabelScale(float scale)
+{
+	gltLabelScale = scale;
+}
+
+GLT_API void
+gltDrawLabels(GLTlabels *l)
+{
+	if (l->vertexCount == 0) {
+		return;
+	}
+
+	GLT_COUNT(drawCount, 1);
+	GLT_COUNT(vertexBytes, l->vertexCount * sizeof(GLTlabelVertex));
+
+	GLT_ZONE_BEGIN("draw");
+	gltUpdateViewport();
+	GLTlabelState state;
+	for (int i = 0; i < 16; i++) {
+		state.view[i] = gltLabelView[i];
+		state.projection[i] = gltLabelProjection[i];
+	}
+
+	for (int i = 0; i < 4; i++) {
+		state.color[i] = gltColor[i];
+	}
+
+	state.viewport[0] = gltViewport[2];
+	state.viewport[1] = gltViewport[3];
+	state.scale = gltLabelScale;
+	gltRestoreAtlas();
+	state.texture = gltGlobalCache.textureAtlas;
+	state.effect = gltEffect;
+
+	GLTbackend *backend = gltCurrentBackend();
+	if (backend->drawLabels) {
+		backend->drawLabels(backend->user, l, &state);
+	}
+	l->vertexCount = 0;
+	GLT_ZONE_END("draw");
+}
+
+GLT_API void
+gltLabelsFree(GLTlabels *l)
+{
+	l->vertices = (GLTlabelVertex *)gltRealloc(l->allocator, l->vertices,
+		4 * l->maxGlyphCount * sizeof(*l->vertices), 0);
+	l->vertexCount = 0;
+	l->maxGlyphCount = 0;
+}
+
+GLT_API void
+gltSetAtlasStorage(GLbitfield storage)
+{
+	gltAtlasStorage = storage;
+}
+
+/* Divides by 255 with rounding, exact for all products of two bytes */
+#define GLT_DIV255(x) (((x) + 128 + (((x) + 128) >> 8)) >> 8)
+
+/*
+ * Blends a span of pixels with the given coverage. Like gltDrawBuffer, the
+ * source is the color scaled by the coverage and blended with its own alpha.
+ */
+static void
+gltBlendSpan(unsigned char *dst, const unsigned char *coverage, int count,
+	const unsigned char *color, int channels)
+{
+	int i = 0;
+#ifdef __SSE2__
+	__m128i zero = _mm_setzero_si128();
+	__m128i one = _mm_set1_epi16(255);
+	__m128i half = _mm_set1_epi16(128);
+#define GLT_DIV255_SSE2(x) _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16((x), half), \
+	_mm_srli_epi16(_mm_add_epi16((x), half), 8)), 8)
+
+	if (channels == 4) {
+		__m128i rgba = _mm_set_epi16(color[3], color[2], color[1], color[0],
+			color[3], color[2], color[1], color[0]);
+		for (; i + 4 <= count; i += 4) {
+			__m128i pixels = _mm_loadu_si128((__m128i *)(dst + 4 * i));
+			__m128i result[2];
+			for (int k = 0; k < 2; k++) {
+				short a0 = coverage[i + 2 * k];
+				short a1 = coverage[i + 2 * k + 1];
+				__m128i a = _mm_set_epi16(a1, a1, a1, a1, a0, a0, a0, a0);
+				__m128i d = k == 0 ? _mm_unpacklo_epi8(pixels, zero)
+					: _mm_unpackhi_epi8(pixels, zero);
+				__m128i src = GLT_DIV255_SSE2(_mm_mullo_epi16(rgba, a));
+				__m128i srcAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src,
+					_MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				__m128i sum = _mm_add_epi16(_mm_mullo_epi16(src, srcAlpha),
+					_mm_mullo_epi16(d, _mm_sub_epi16(one, srcAlpha)));
+				result[k] = GLT_DIV255_SSE2(sum);
+			}
+
+			_mm_storeu_si128((__m128i *)(dst + 4 * i), _mm_packus_epi16(result[0], result[1]));
+		}
+	} else {
+		__m128i red = _mm_set1_epi16(color[0]);
+		__m128i alpha = _mm_set1_epi16(color[3]);
+		for (; i + 8 <= count; i += 8) {
+			__m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(coverage + i)), zero);
+			__m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(dst + i)), zero);
+			__m128i src = GLT_DIV255_SSE2(_mm_mullo_epi16(red, a));
+			__m128i srcAlpha = GLT_DIV255_SSE2(_mm_mullo_epi16(alpha, a));
+			__m128i sum = _mm_add_epi16(_mm_mullo_epi16(src, srcAlpha),
+				_mm_mullo_epi16(d, _mm_sub_epi16(one, srcAlpha)));
+			_mm_storel_epi64((__m128i *)(dst + i),
+				_mm_packus_epi16(GLT_DIV255_SSE2(sum), zero));
+		}
+	}
+#undef GLT_DIV255_SSE2
+#endif /* __SSE2__ */
+
+	for (; i < count; i++) {
+		int a = coverage[i];
+		int srcAlpha = GLT_DIV255(color[3] * a);
+		unsigned char *pixel = dst + channels * i;
+		for (int k = 0; k < channels; k++) {
+			int src = GLT_DIV255(color[channels == 4 ? k : 0] * a);
+			int sum = src * srcAlpha + pixel[k] * (255 - srcAlpha);
+			pixel[k] = GLT_DIV255(sum);
+		}
+	}
+}
+
+GLT_API void
+gltRasterizeTile(const GLTbuffer *b, GLTimage *image, int x, int y, int width, int height)
+{
+	const unsigned char *atlas = gltGlobalCache.pixels;
+	if (!atlas || (image->channels != 1 && image->channels != 4)) {
+		return;
+	}
+
+	int tileMinX = x < 0 ? 0 : x;
+	int tileMinY = y < 0 ? 0 : y;
+	int tileMaxX = x + width < image->width ? x + width : image->width;
+	int tileMaxY = y + height < image->height ? y + height : image->height;
+
+	unsigned char coverage[1024];
+	for (GLsizei i = 0; i + 4 <= b->vertexCount; i += 4) {
+		/* The first vertex is the lower left and the last the upper right corner */
+		const GLTvertex *min = &b->vertices[i];
+		const GLTvertex *max = &b->vertices[i + 3];
+		if (max->x <= min->x || max->y <= min->y) {
+			continue;
+		}
+
+		/* Pixels whose center is inside of the quad */
+		int minX = (int)(min->x + 0.5f) - (min->x + 0.5f < 0);
+		int minY = (int)(min->y + 0.5f) - (min->y + 0.5f < 0);
+		int maxX = (int)(max->x + 0.5f) - (max->x + 0.5f < 0);
+		int maxY = (int)(max->y + 0.5f) - (max->y + 0.5f < 0);
+		minX = minX < tileMinX ? tileMinX : minX;
+		minY = minY < tileMinY ? tileMinY : minY;
+		maxX = maxX > tileMaxX ? tileMaxX : maxX;
+		maxY = maxY > tileMaxY ? tileMaxY : maxY;
+		if (minX >= maxX || minY >= maxY) {
+			continue;
+		}
+
+		unsigned char color[4];
+		for (int k = 0; k < 4; k++) {
+			color[k] = gltColorByte(min->color[k] * gltColor[k]);
+		}
+
+		float scaleU = 1024 * (max->u - min->u) / (max->x - min->x);
+		float scaleV = 1024 * (max->v - min->v) / (max->y - min->y);
+		for (int py = minY; py < maxY; py++) {
+			int texelY = 1024 * min->v + (py + 0.5f - min->y) * scaleV;
+			texelY = texelY < 0 ? 0 : texelY > 1023 ? 1023 : texelY;
+			const unsigned char *texels = atlas + 1024 * texelY;
+			unsigned char *row = image->pixels + (image->height - 1 - py) * image->stride;
+
+			for (int px = minX; px < maxX; px += 1024) {
+				int count = maxX - px < 1024 ? maxX - px : 1024;
+				for (int j = 0; j < count; j++) {
+					int texelX = 1024 * min->u + (px + j + 0.5f - min->x) * scaleU;
+					coverage[j] = texels[texelX < 0 ? 0 : texelX > 1023 ? 1023 : texelX];
+				}
+
+				gltBlendSpan(row + image->channels * px, coverage, count, color, image->channels);
+			}
+		}
+	}
+}
+
+GLT_API void
+gltRasterizeBuffer(GLTbuffer *b, GLTimage *image)
+{
+	gltRasterizeTile(b, image, 0, 0, image->width, image->height);
+	gltBufferReset(b);
+}
+
+/*
+ * Makes sure that the CPU copy of the text can hold maxLength characters.
+ */
+static GLboolean
+gltTextReserve(GLTtext *t, GLsizei maxLength)
+{
+	if (maxLength < 1) {
+		maxLength = 1;
+	}
+
+	if (!gltBufferReserve(&t->geometry, maxLength)) {
+		return GL_FALSE;
+	}
+
+	if (maxLength > t->maxLength) {
+		maxLength = t->geometry.maxGlyphCount;
+
+		char *text = (char *)gltRealloc(NULL, t->text,
+			t->maxLength * sizeof(*t->text), maxLength * sizeof(*t->text));
+		if (!text) {
+			return GL_FALSE;
+		}
+
+		t->text = text;
+
+		float *offsets = (float *)gltRealloc(NULL, t->offsets,
+			(t->maxLength + 1) * sizeof(*t->offsets),
+			(maxLength + 1) * sizeof(*t->offsets));
+		if (!offsets) {
+			return GL_FALSE;
+		}
+
+		t->offsets = offsets;
+		t->maxLength = maxLength;
+	}
+
+	return GL_TRUE;
+}
+
+/*
+ * Uploads the quads in the range [first, last) of the geometry. If the GPU
+ * buffers are too small, they are recreated from the whole geometry instead.
+ */
+static void
+gltGLUploadText(void *user, GLTtext *t, GLsizei first, GLsizei last)
+{
+	(void)user;
+
+	GLTbuffer *b = &t->geometry;
+	if (!t->vertexArray) {
+		glGenBuffers(1, &t->vertexBuffer);
+		glGenBuffers(1, &t->indexBuffer);
+		t->vertexArray = gltCreateVertexArray(t->vertexBuffer, t->indexBuffer);
+	}
+
+	gltBindVertexArray(t->vertexArray);
+	gltBindArrayBuffer(t->vertexBuffer);
+	if (t->length > t->maxGlyphCount) {
+		t->maxGlyphCount = b->maxGlyphCount;
+		glBufferData(GL_ARRAY_BUFFER, t->maxGlyphCount * GLT_VERTEX_BYTES,
+			NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, t->length * GLT_VERTEX_BYTES, b->vertices);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, t->maxGlyphCount * GLT_INDEX_BYTES,
+			NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, t->length * GLT_INDEX_BYTES, b->indices);
+	} else {
+		if (first < last) {
+			glBufferSubData(GL_ARRAY_BUFFER, first * GLT_VERTEX_BYTES,
+				(last - first) * GLT_VERTEX_BYTES, b->vertices + 4 * first);
+		}
+
+		/* The indices of a quad only depend on its position */
+		GLsizei indexedGlyphCount = t->indexCount / 6;
+		if (t->length > indexedGlyphCount) {
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexedGlyphCount * GLT_INDEX_BYTES,
+				(t->length - indexedGlyphCount) * GLT_INDEX_BYTES,
+				b->indices + 6 * indexedGlyphCount);
+		}
+	}
+
+	t->indexCount = 6 * t->length;
+}
+
+static unsigned long long
+gltHashBytes(unsigned long long hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+
+	return hash;
+}
+
+/* Grows the rectangle to contain the other one, empty ones are ignored */
+static void
+gltUnionRect(GLint *rect, const GLint *other)
+{
+	if (other[2] <= 0 || other[3] <= 0) {
+		return;
+	}
+
+	if (rect[2] <= 0 || rect[3] <= 0) {
+		for (int i = 0; i < 4; i++) {
+			rect[i] = other[i];
+		}
+
+		return;
+	}
+
+	GLint xMax = rect[0] + rect[2];
+	GLint yMax = rect[1] + rect[3];
+	if (xMax < other[0] + other[2]) {
+		xMax = other[0] + other[2];
+	}
+
+	if (yMax < other[1] + other[3]) {
+		yMax = other[1] + other[3];
+	}
+
+	if (rect[0] > other[0]) {
+		rect[0] = other[0];
+	}
+
+	if (rect[1] > other[1]) {
+		rect[1] = other[1];
+	}
+
+	rect[2] = xMax - rect[0];
+	rect[3] = yMax - rect[1];
+}
+
+/*
+ * Finds the window rectangle covered by the bounds of the text. Corners behind
+ * the camera have no window position, so the whole viewport is used instead.
+ */
+static void
+gltTextRect(const GLTtext *t, const GLTdrawState *state, GLint *rect)
+{
+	const GLint *viewport = gltViewport;
+	const GLfloat *m = state->transform;
+	rect[2] = 0;
+	rect[3] = 0;
+	if (t->bounds[0] >= t->bounds[2] || t->bounds[1] >= t->bounds[3]) {
+		return;
+	}
+
+	float xMin = viewport[0] + viewport[2];
+	float yMin = viewport[1] + viewport[3];
+	float xMax = viewport[0];
+	float yMax = viewport[1];
+	for (int i = 0; i < 4; i++) {
+		float x = t->bounds[i & 1 ? 2 : 0] + state->offset[0];
+		float y = t->bounds[i & 2 ? 3 : 1] + state->offset[1];
+		float w = m[3] * x + m[7] * y + m[15];
+		if (w <= 0) {
+			xMin = viewport[0];
+			yMin = viewport[1];
+			xMax = viewport[0] + viewport[2];
+			yMax = viewport[1] + viewport[3];
+			break;
+		}
+
+		float windowX = viewport[0] + ((m[0] * x + m[4] * y + m[12]) / w + 1) * 0.5f * viewport[2];
+		float windowY = viewport[1] + ((m[1] * x + m[5] * y + m[13]) / w + 1) * 0.5f * viewport[3];
+		xMin = windowX < xMin ? windowX : xMin;
+		yMin = windowY < yMin ? windowY : yMin;
+		xMax = windowX > xMax ? windowX : xMax;
+		yMax = windowY > yMax ? windowY : yMax;
+	}
+
+	/* Round outwards and clip to the viewport */
+	xMin = xMin > viewport[0] ? xMin : viewport[0];
+	yMin = yMin > viewport[1] ? yMin : viewport[1];
+	xMax = xMax < viewport[0] + viewport[2] ? xMax : viewport[0] + viewport[2];
+	yMax = yMax < viewport[1] + viewport[3] ? yMax : viewport[1] + viewport[3];
+	if (xMin < xMax && yMin < yMax) {
+		rect[0] = (GLint)xMin;
+		rect[1] = (GLint)yMin;
+		rect[2] = (GLint)xMax + (xMax > (GLint)xMax) - rect[0];
+		rect[3] = (GLint)yMax + (yMax > (GLint)yMax) - rect[1];
+	}
+}
+
+/* Encloses all quads of the text, ignoring empty ones */
+static void
+gltTextBounds(GLTtext *t)
+{
+	GLTbuffer *b = &t->geometry;
+	t->bounds[0] = t->bounds[1] = t->bounds[2] = t->bounds[3] = 0;
+	t->hasBounds = GL_TRUE;
+	GLboolean isEmpty = GL_TRUE;
+	for (GLsizei i = 0; i < t->length; i++) {
+		/* The first and the last vertex are opposite corners of the quad */
+		GLTvertex *a = &b->vertices[4 * i];
+		GLTvertex *c = &b->vertices[4 * i + 3];
+		if (a->x == c->x || a->y == c->y) {
+			continue;
+		}
+
+		float xMin = a->x < c->x ? a->x : c->x;
+		float yMin = a->y < c->y ? a->y : c->y;
+		float xMax = a->x > c->x ? a->x : c->x;
+		float yMax = a->y > c->y ? a->y : c->y;
+		if (isEmpty || xMin < t->bounds[0]) {
+			t->bounds[0] = xMin;
+		}
+
+		if (isEmpty || yMin < t->bounds[1]) {
+			t->bounds[1] = yMin;
+		}
+
+		if (isEmpty || xMax > t->bounds[2]) {
+			t->bounds[2] = xMax;
+		}
+
+		if (isEmpty || yMax > t->bounds[3]) {
+			t->bounds[3] = yMax;
+		}
 
-	return shader;
+		isEmpty = GL_FALSE;
+	}
 }
 
-GLT_API void
-gltUseProgram(void)
+/*
+ * Damages the old and the new rectangle if the text, its state or the
+ * viewport changed.
+ */
+static void
+gltDamageText(GLTtext *t, const GLTdrawState *state)
 {
-	if (!gltProgram) {
-		static const char *vertexSource = "#version 330 core\n"
-			"layout (location = 0) in vec2 aPos;\n"
-			"layout (location = 1) in vec2 aTexCoords;\n"
-			"uniform mat4 transform;\n"
-			"out vec2 vTexCoords;\n"
-			"void main()\n"
-			"{\n"
-			"    vTexCoords = aTexCoords;\n"
-			"    gl_Position = transform * vec4(aPos, 0.0, 1.0);\n"
-			"}\n";
-
-		static const char *fragmentSource = "#version 330 core\n"
-			"in vec2 vTexCoords;\n"
-			"uniform vec4 color;\n"
-			"uniform sampler2D textureAtlas;"
-			"out vec4 fragColor;\n"
-			"void main()\n"
-			"{"
-			"    float alpha = texture(textureAtlas, vTexCoords).r;"
-			"    fragColor = mix(vec4(0), color, alpha);\n"
-			"}\n";
-
-		GLuint vertexShader = gltCreateShader(GL_VERTEX_SHADER, vertexSource);
-		GLuint fragmentShader = gltCreateShader(GL_FRAGMENT_SHADER, fragmentSource);
-
-		gltProgram = glCreateProgram();
-		glAttachShader(gltProgram, vertexShader);
-		glAttachShader(gltProgram, fragmentShader);
-		glLinkProgram(gltProgram);
-
-		int linkStatus = 0;
-		glGetProgramiv(gltProgram, GL_LINK_STATUS, &linkStatus);
-		if (linkStatus == 0) {
-			char infoLog[1024] = {0};
-			glGetProgramInfoLog(gltProgram, sizeof(infoLog), NULL, infoLog);
-			fprintf(stderr, "link error: %s\n", infoLog);
-		}
+	gltUpdateViewport();
+	unsigned long long key = gltHashBytes(14695981039346656037ull,
+		&t->version, sizeof(t->version));
+	key = gltHashBytes(key, state, sizeof(*state));
+	key = gltHashBytes(key, gltViewport, sizeof(gltViewport));
+	if (key == t->drawnKey) {
+		return;
+	}
 
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
+	if (!t->hasBounds) {
+		gltTextBounds(t);
+	}
 
-		glUseProgram(gltProgram);
-		GLuint colorLocation = glGetUniformLocation(gltProgram, "color");
-		glUniform4f(colorLocation, 0, 0, 0, 1);
+	GLint rect[4];
+	gltTextRect(t, state, rect);
+	gltUnionRect(gltDamage, t->drawnRect);
+	gltUnionRect(gltDamage, rect);
+	for (int i = 0; i < 4; i++) {
+		t->drawnRect[i] = rect[i];
 	}
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glUseProgram(gltProgram);
+	t->drawnKey = key;
 }
 
-GLT_API void
-gltSetTransform(float *matrix, GLboolean transpose)
+static void
+gltTextUpload(GLTtext *t, GLsizei first, GLsizei last)
 {
-	gltHasChangedTransform = 1;
+	GLTbackend *backend = gltCurrentBackend();
+	if (first < last) {
+		GLT_COUNT(vertexBytes, (last - first) * GLT_VERTEX_BYTES);
+	}
 
-	gltUseProgram();
-	GLuint transformLocation = glGetUniformLocation(gltProgram, "transform");
-	glUniformMatrix4fv(transformLocation, 1, transpose, matrix);
+	backend->uploadText(backend->user, t, first, last);
 }
 
 GLT_API void
-gltSetColorRGBA(float r, float g, float b, float a)
+gltReplaceText(GLTtext *t, GLsizei start, GLsizei length, char *text, GLsizei count)
 {
-	gltUseProgram();
-	GLuint colorLocation = glGetUniformLocation(gltProgram, "color");
-	glUniform4f(colorLocation, r, g, b, a);
-}
+	static GLTglyph emptyGlyph;
 
-GLT_API void
-gltOrtho(float left, float right, float bottom, float top, float zNear, float zFar)
-{
-	float matrix[4][4] = {0};
+	GLTglyph *glyphs = gltUpdateCache();
+	if (!glyphs) {
+		return;
+	}
 
-	matrix[0][0] = 2. / (right - left);
-	matrix[1][1] = 2. / (top - bottom);
-	matrix[2][2] = -2. / (zFar - zNear);
-	matrix[3][3] = 1.;
+	if (start > t->length) {
+		start = t->length;
+	}
 
-	matrix[0][3] = - (right + left) / (right - left);
-	matrix[1][3] = - (top + bottom) / (top - bottom);
-	matrix[2][3] = - (zFar + zNear) / (zFar - zNear);
+	if (length > t->length - start) {
+		length = t->length - start;
+	}
 
-	gltSetTransform(matrix[0], GL_TRUE);
-}
+	/* Zero means that the text was built with different styles */
+	unsigned long long style = gltHashBytes(14695981039346656037ull,
+		&gltCurrentFont, sizeof(gltCurrentFont));
+	style = gltHashBytes(style, gltVertexColor, sizeof(gltVertexColor));
+	style = gltHashBytes(style, &gltGlyphPadding, sizeof(gltGlyphPadding));
+	if (count == length && style == t->style) {
+		GLsizei i = 0;
+		while (i < count && t->text[start + i] == text[i]) {
+			i++;
+		}
 
-GLT_API void
-gltDrawBuffer(GLTbuffer *b)
-{
-	if (!gltHasChangedTransform) {
-		GLint viewport[4];
-		glGetIntegerv(GL_VIEWPORT, viewport);
+		if (i == count) {
+			return;
+		}
+	}
 
-		float left = viewport[0];
-		float right = left + viewport[2];
-		float bottom = viewport[1];
-		float top = bottom + viewport[3];
-		gltOrtho(left, right, bottom, top, -1, 1);
+	GLsizei tailLength = t->length - start - length;
+	GLsizei newLength = start + count + tailLength;
+	if (!gltTextReserve(t, newLength)) {
+		return;
+	}
 
-		/* To keep changing it every frame until the user sets it */
-		gltHasChangedTransform = 0;
+	GLT_ZONE_BEGIN("push");
+	if (t->length == 0) {
+		t->offsets[0] = 0;
 	}
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), b->vertices);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), b->vertices + 2);
-	glDrawElements(GL_TRIANGLES, b->indexCount, GL_UNSIGNED_INT, b->indices);
+	/* Move the characters after the replaced range to their new position */
+	GLTbuffer *b = &t->geometry;
+	float x = t->offsets[start];
+	float oldEnd = t->offsets[start + length];
+	if (count != length) {
+		gltMoveMemory(t->text + start + count, t->text + start + length,
+			tailLength * sizeof(*t->text));
+		gltMoveMemory(t->offsets + start + count, t->offsets + start + length,
+			(tailLength + 1) * sizeof(*t->offsets));
+		gltMoveMemory(b->vertices + 4 * (start + count), b->vertices + 4 * (start + length),
+			tailLength * GLT_VERTEX_BYTES);
+	}
 
-	b->vertexCount = 0;
-	b->indexCount = 0;
+	/* Emit exactly one quad per character, so that characters map to quads */
+	b->vertexCount = 4 * start;
+	b->indexCount = 6 * start;
+	GLT_COUNT(glyphCount, count);
+	GLT_COUNT(quadCount, count);
+	for (GLsizei i = 0; i < count; i++) {
+		unsigned char c = text[i];
+		GLTglyph *glyph = c < 128 ? &glyphs[c] : &emptyGlyph;
+
+		t->text[start + i] = c;
+		t->offsets[start + i] = x;
+		gltEmitGlyph(b, glyph, x, 0);
+		x += glyph->advance;
+	}
+
+	GLsizei last = start + count;
+	float shift = x - oldEnd;
+	if (shift != 0) {
+		for (GLsizei i = start + count; i < newLength; i++) {
+			GLTvertex *vertex = b->vertices + 4 * i;
+			vertex[0].x += shift;
+			vertex[1].x += shift;
+			vertex[2].x += shift;
+			vertex[3].x += shift;
+			t->offsets[i] += shift;
+		}
+
+		t->offsets[newLength] += shift;
+		last = newLength;
+	} else if (count != length) {
+		last = newLength;
+	}
+
+	/* Indices of the moved quads stay valid, only new ones are appended */
+	GLsizei firstIndexedGlyph = start + count;
+	if (firstIndexedGlyph < t->length) {
+		firstIndexedGlyph = t->length;
+	}
+
+	for (GLsizei i = firstIndexedGlyph; i < newLength; i++) {
+		GLuint *index = b->indices + 6 * i;
+		index[0] = 4 * i + 0;
+		index[1] = 4 * i + 1;
+		index[2] = 4 * i + 3;
+		index[3] = 4 * i + 0;
+		index[4] = 4 * i + 3;
+		index[5] = 4 * i + 2;
+	}
+
+	t->length = newLength;
+	b->vertexCount = 4 * newLength;
+	b->indexCount = 6 * newLength;
+	if (start == 0 && tailLength == 0) {
+		t->style = style;
+	} else if (count > 0 && style != t->style) {
+		t->style = 0;
+	}
+
+	/* Unchanged edits returned early, so every edit damages the text */
+	t->version++;
+	t->hasBounds = GL_FALSE;
+
+	gltTextUpload(t, start, last);
+	GLT_ZONE_END("push");
 }
 
 GLT_API void
-gltPushnText(GLTbuffer *b, float x, float y, char *text, GLsizei count)
+gltPushTextBatch(GLTbuffer *b, const GLTtextItem *items, GLsizei count)
 {
-	if (gltCurrentFont == 0) {
+	GLTglyph *glyphs = gltUpdateCache();
+	if (!glyphs) {
 		return;
 	}
 
-	GLTcache *cache = &gltGlobalCache;
-	if (!cache->textureAtlas) {
-		glGenTextures(1, &cache->textureAtlas);
-		glBindTexture(GL_TEXTURE_2D, cache->textureAtlas);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 1024, 1024, 0,
-			GL_RED, GL_UNSIGNED_BYTE, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	/* Null-terminated strings are measured once, when they are pushed */
+	GLsizei knownCount = 0;
+	for (GLsizei i = 0; i < count; i++) {
+		if (items[i].length > 0) {
+			knownCount += items[i].length;
+		}
 	}
 
-	FT_Face face = gltFonts[gltCurrentFont];
-	for (int c = 32; c < 127; c++) {
-		if (cache->glyphs[c].codepoint != 0) {
-			continue;
-		}
+	if (!gltBufferReserve(b, b->vertexCount / 4 + knownCount)) {
+		return;
+	}
 
-		if (FT_Load_Char(face, c, FT_LOAD_RENDER) != 0) {
-			continue;
+	GLT_ZONE_BEGIN("push");
+	GLuint vertexColor = GLT_RGBA(gltVertexColor[0], gltVertexColor[1],
+		gltVertexColor[2], gltVertexColor[3]);
+	for (GLsizei i = 0; i < count; i++) {
+		const GLTtextItem *item = &items[i];
+		GLuint color = item->color ? item->color : vertexColor;
+		gltVertexColor[0] = color >> 24;
+		gltVertexColor[1] = color >> 16;
+		gltVertexColor[2] = color >> 8;
+		gltVertexColor[3] = color;
+
+		GLsizei length = item->length;
+		if (length < 0) {
+			length = gltTextLength(item->text);
+			if (!gltBufferReserve(b, b->vertexCount / 4 + length + knownCount)) {
+				break;
+			}
+		} else {
+			knownCount -= length;
 		}
 
-		FT_GlyphSlot glyphSlot = face->glyph;
-		FT_Bitmap bitmap = glyphSlot->bitmap;
+		gltPushGlyphs(b, glyphs, item->x, item->y, item->text, length);
+	}
 
-		if (cache->currentOffsetX + bitmap.width > 1024) {
-			cache->currentOffsetX = 0;
-			cache->currentOffsetY += cache->currentRowHeight;
-			cache->currentRowHeight = 0;
-		}
+	gltVertexColor[0] = vertexColor >> 24;
+	gltVertexColor[1] = vertexColor >> 16;
+	gltVertexColor[2] = vertexColor >> 8;
+	gltVertexColor[3] = vertexColor;
+	GLT_ZONE_END("push");
+}
 
-		float width = bitmap.width;
-		float height = bitmap.rows;
+GLT_API void
+gltSetnText(GLTtext *t, char *text, GLsizei count)
+{
+	gltReplaceText(t, 0, t->length, text, count);
+}
 
-		GLTglyph *glyph = cache->glyphs + c;
-		glyph->codepoint = c;
-		glyph->xMin = cache->currentOffsetX;
-		glyph->yMin = cache->currentOffsetY;
-		glyph->xMax = glyph->xMin + width;
-		glyph->yMax = glyph->yMin + height;
-		glyph->advance = glyphSlot->advance.x / 64.;
-		glyph->bearingX = glyphSlot->bitmap_left;
-		glyph->bearingY = glyphSlot->bitmap_top - height;
+GLT_API void
+gltSetText(GLTtext *t, char *text)
+{
+	GLsizei length = gltTextLength(text);
+	gltSetnText(t, text, length);
+}
 
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, cache->currentOffsetX, cache->currentOffsetY,
-			width, height, GL_RED, GL_UNSIGNED_BYTE, bitmap.buffer);
+static void
+gltGLDrawText(void *user, GLTtext *t, const GLTdrawState *state)
+{
+	(void)user;
 
-		cache->currentOffsetX += bitmap.width;
-		if (bitmap.rows > cache->currentRowHeight) {
-			cache->currentRowHeight = bitmap.rows;
-		}
+	if (t->indexCount == 0) {
+		return;
 	}
 
-	char *at = text;
-	while (count-- > 0) {
-		int c = *at++;
-		if (c >= 128) {
-			continue;
+	GLboolean isTimed = gltBeginTimer(GLT_TIMER_DRAW);
+	gltGLUseState(state);
+	gltBindVertexArray(t->vertexArray);
+	glDrawElements(GL_TRIANGLES, t->indexCount, GL_UNSIGNED_INT, NULL);
+	gltEndTimer(isTimed);
+}
+
+static GLuint gltLabelVertexArray;
+
+/* Copies the labels into the stream and generates the indices of the quads */
+static void
+gltGLDrawLabels(void *user, GLTlabels *l, const GLTlabelState *state)
+{
+	(void)user;
+
+	GLTstream *stream = &gltStream;
+	gltStreamInit(stream);
+	if (!gltLabelVertexArray) {
+		glGenVertexArrays(1, &gltLabelVertexArray);
+		gltBindVertexArray(gltLabelVertexArray);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream->buffer);
+		for (GLuint i = 0; i < 4; i++) {
+			glEnableVertexAttribArray(i);
 		}
+	}
 
-		if (b->vertexCount + 4 > b->maxVertexCount) {
-			if (b->maxVertexCount == 0) {
-				b->maxVertexCount = 1024;
-			} else {
-				b->maxVertexCount *= 2;
-			}
+	GLTprogram *p = gltHasEffect(&state->effect) ? &gltLabelEffectProgram : &gltLabelProgram;
+	GLboolean isTimed = gltBeginTimer(GLT_TIMER_DRAW);
+	gltEnableBlend();
+	gltBindProgram(gltFinishProgram(p));
+	gltBindTexture(state->texture);
+	gltBindVertexArray(gltLabelVertexArray);
+	glUniformMatrix4fv(p->locations[GLT_LOCATION_VIEW], 1, GL_FALSE, state->view);
+	glUniformMatrix4fv(p->locations[GLT_LOCATION_PROJECTION], 1, GL_FALSE, state->projection);
+	glUniform2fv(p->locations[GLT_LOCATION_VIEWPORT], 1, state->viewport);
+	glUniform1f(p->locations[GLT_LOCATION_SCALE], state->scale);
+	glUniform4fv(p->locations[GLT_LOCATION_COLOR], 1, state->color);
+	gltUseEffect(p, &state->effect);
 
-			GLsizei size = b->maxVertexCount * 4 * sizeof(*b->vertices);
-			b->vertices = (GLfloat *)GLT_REALLOC(b->vertices, size);
+	GLsizei glyphCount = l->vertexCount / 4;
+	GLsizei maxPartSize = GLT_STREAM_SIZE / (2 * (4 * sizeof(GLTlabelVertex) + GLT_INDEX_BYTES));
+	for (GLsizei first = 0; first < glyphCount; first += maxPartSize) {
+		GLsizei count = glyphCount - first;
+		if (count > maxPartSize) {
+			count = maxPartSize;
 		}
 
-		if (b->indexCount + 6 > b->maxIndexCount) {
-			if (b->maxIndexCount == 0) {
-				b->maxIndexCount = 1024;
-			} else {
-				b->maxIndexCount *= 2;
-			}
+		GLsizeiptr vertexSize = 4 * count * sizeof(GLTlabelVertex);
+		GLsizeiptr size = vertexSize + count * GLT_INDEX_BYTES;
+		GLsizeiptr offset = gltStreamAcquire(stream, size);
+		if (offset < 0) {
+			break;
+		}
+
+		unsigned char *data = gltStreamMap(stream, offset, size);
+		if (!data) {
+			break;
+		}
 
-			GLsizei size = b->maxIndexCount * sizeof(*b->indices);
-			b->indices = (GLuint *)GLT_REALLOC(b->indices, size);
+		gltMoveMemory(data, l->vertices + 4 * first, vertexSize);
+		GLuint *index = (GLuint *)(data + vertexSize);
+		for (GLuint i = 0; i < (GLuint)count; i++) {
+			*index++ = 4 * i + 0;
+			*index++ = 4 * i + 1;
+			*index++ = 4 * i + 3;
+			*index++ = 4 * i + 0;
+			*index++ = 4 * i + 3;
+			*index++ = 4 * i + 2;
 		}
 
-		GLTglyph *glyph = &cache->glyphs[c];
-		float width = glyph->xMax - glyph->xMin;
-		float height = glyph->yMax - glyph->yMin;
+		if (!gltStreamUnmap(stream)) {
+			break;
+		}
 
-		float *vertex = b->vertices + 4 * b->vertexCount;
-		unsigned int *index = b->indices + b->indexCount;
-		float xPos = x + glyph->bearingX;
-		float yPos = y + glyph->bearingY;
+		stream->stats.bytesCopied += size;
 
-		*vertex++ = xPos;
-		*vertex++ = yPos;
-		*vertex++ = glyph->xMin / 1024.;
-		*vertex++ = glyph->yMax / 1024.;
+		/* The vertices of every part start at a different offset */
+		gltBindArrayBuffer(stream->buffer);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLTlabelVertex),
+			(void *)(offset + offsetof(GLTlabelVertex, anchor)));
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLTlabelVertex),
+			(void *)(offset + offsetof(GLTlabelVertex, x)));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GLTlabelVertex),
+			(void *)(offset + offsetof(GLTlabelVertex, u)));
+		glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GLTlabelVertex),
+			(void *)(offset + offsetof(GLTlabelVertex, color)));
+		glDrawElements(GL_TRIANGLES, 6 * count, GL_UNSIGNED_INT, (void *)(offset + vertexSize));
+		gltStreamRelease(stream, offset, GL_TRUE);
+	}
 
-		*vertex++ = xPos + width;
-		*vertex++ = yPos;
-		*vertex++ = glyph->xMax / 1024.;
-		*vertex++ = glyph->yMax / 1024.;
+	gltEndTimer(isTimed);
+}
 
-		*vertex++ = xPos;
-		*vertex++ = yPos + height;
-		*vertex++ = glyph->xMin / 1024.;
-		*vertex++ = glyph->yMin / 1024.;
+GLT_API void
+gltDrawTextObject(GLTtext *t, float x, float y)
+{
+	gltUpdateTransform();
+	GLTdrawState state;
+	gltInitDrawState(&state, x, y);
+	gltDamageText(t, &state);
+	if (t->length == 0) {
+		return;
+	}
 
-		*vertex++ = xPos + width;
-		*vertex++ = yPos + height;
-		*vertex++ = glyph->xMax / 1024.;
-		*vertex++ = glyph->yMin / 1024.;
+	GLT_COUNT(drawCount, 1);
 
-		*index++ = b->vertexCount + 0;
-		*index++ = b->vertexCount + 1;
-		*index++ = b->vertexCount + 3;
+	GLT_ZONE_BEGIN("draw");
+	GLTbackend *backend = gltCurrentBackend();
+	backend->drawText(backend->user, t, &state);
+	GLT_ZONE_END("draw");
+}
 
-		*index++ = b->vertexCount + 0;
-		*index++ = b->vertexCount + 3;
-		*index++ = b->vertexCount + 2;
+GLT_API void
+gltTrackText(GLTtext *t, float x, float y)
+{
+	gltUpdateTransform();
+	GLTdrawState state;
+	gltInitDrawState(&state, x, y);
+	gltDamageText(t, &state);
+}
 
-		x += glyph->advance;
-		b->vertexCount += 4;
-		b->indexCount += 6;
+GLT_API GLboolean
+gltGetDamage(GLint *rect)
+{
+	for (int i = 0; i < 4; i++) {
+		rect[i] = gltDamage[i];
 	}
+
+	return gltDamage[2] > 0 && gltDamage[3] > 0;
 }
 
-static GLsizei
-gltTextLength(char *text)
+static void
+gltGLDeleteText(void *user, GLTtext *t)
 {
-	GLsizei length = 0;
-	while (text[length] != 0) {
-		length++;
+	(void)user;
+
+	/* Deleting bound objects resets their binding to zero */
+	if (t->vertexArray && gltState.vertexArray == t->vertexArray) {
+		gltState.vertexArray = 0;
 	}
 
-	return length;
+	if (t->vertexBuffer && gltState.arrayBuffer == t->vertexBuffer) {
+		gltState.arrayBuffer = 0;
+	}
+
+	glDeleteVertexArrays(1, &t->vertexArray);
+	glDeleteBuffers(1, &t->vertexBuffer);
+	glDeleteBuffers(1, &t->indexBuffer);
+
+	t->vertexArray = 0;
+	t->vertexBuffer = 0;
+	t->indexBuffer = 0;
+	t->indexCount = 0;
+	t->maxGlyphCount = 0;
 }
 
 GLT_API void
-gltPushText(GLTbuffer *b, float x, float y, char *text)
+gltDeleteText(GLTtext *t)
 {
-	GLsizei length = gltTextLength(text);
-	gltPushnText(b, x, y, text, length);
+	GLTbackend *backend = gltCurrentBackend();
+	backend->deleteText(backend->user, t);
+	gltBufferFree(&t->geometry);
+	gltUnionRect(gltDamage, t->drawnRect);
+
+	t->text = (char *)gltRealloc(NULL, t->text, t->maxLength * sizeof(*t->text), 0);
+	t->offsets = (float *)gltRealloc(NULL, t->offsets,
+		(t->maxLength + 1) * sizeof(*t->offsets), 0);
+	t->length = 0;
+	t->maxLength = 0;
+	t->style = 0;
+	t->version = 0;
+	t->hasBounds = GL_FALSE;
+	t->drawnKey = 0;
+	for (int i = 0; i < 4; i++) {
+		t->bounds[i] = 0;
+		t->drawnRect[i] = 0;
+	}
 }
 
 GLT_API void
 gltDrawnText(float x, float y, char *text, GLsizei count)
 {
 	GLTbuffer b = {0};
+	b.allocator = gltFrameAllocator();
 	gltPushnText(&b, x, y, text, count);
 	gltDrawBuffer(&b);
-
-	free(b.vertices);
-	free(b.indices);
+	gltBufferFree(&b);
 }
 
 GLT_API void
@@ -389,7 +4704,9 @@ gltMeasurenTextWidth(char *text, GLsizei count)
 {
 	float width = 0;
 
+	GLT_ZONE_BEGIN("measure");
 	FT_Face face = gltFonts[gltCurrentFont];
+	unsigned long long start = GLT_STATS_TIME();
 	char *at = text;
 	while (count-- > 0) {
 		char c = *at++;
@@ -398,6 +4715,8 @@ gltMeasurenTextWidth(char *text, GLsizei count)
 		}
 	}
 
+	GLT_COUNT(freetypeTime, GLT_STATS_TIME() - start);
+	GLT_ZONE_END("measure");
 	return width;
 }
 
@@ -420,17 +4739,21 @@ gltCreateFont(char *filename, int pixelSize)
 		}
 	}
 
-	if (gltFontCount > 256) {
+	if (gltFontCount >= 256) {
 		return 0;
 	}
 
 	GLuint id = gltFontCount++;
 	FT_Face *face = &gltFonts[id];
+	GLT_ZONE_BEGIN("load font");
+	unsigned long long start = GLT_STATS_TIME();
 	if (FT_New_Face(ft, filename, 0, face)) {
 		fprintf(stderr, "Failed to load font\n");
 	}
 
 	FT_Set_Pixel_Sizes(*face, 0, pixelSize);
+	GLT_COUNT(freetypeTime, GLT_STATS_TIME() - start);
+	GLT_ZONE_END("load font");
 	return id;
 }
 
@@ -440,4 +4763,248 @@ gltBindFont(GLuint font)
 	gltCurrentFont = font;
 }
 
+static GLuint
+gltGLCreateTexture(void *user, GLsizei width, GLsizei height)
+{
+	(void)user;
+
+	/* Cleared, since the padding between glyphs is never uploaded */
+	unsigned char *pixels = (unsigned char *)GLT_REALLOC(NULL, width * height);
+	for (long i = 0; pixels && i < (long)width * height; i++) {
+		pixels[i] = 0;
+	}
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	gltBindTexture(texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height, 0,
+		GL_RED, GL_UNSIGNED_BYTE, pixels);
+	(void)GLT_REALLOC(pixels, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	return texture;
+}
+
+static void
+gltGLUpdateTexture(void *user, GLuint texture, GLint x, GLint y,
+	GLsizei width, GLsizei height, GLsizei stride, const unsigned char *pixels)
+{
+	(void)user;
+
+	GLboolean isTimed = gltBeginTimer(GLT_TIMER_UPLOAD);
+	gltBindTexture(texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (stride != width) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+	}
+
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+		GL_RED, GL_UNSIGNED_BYTE, pixels);
+
+	if (stride != width) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+
+	gltEndTimer(isTimed);
+}
+
+static void
+gltGLGetViewport(void *user, GLint *viewport)
+{
+	(void)user;
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+}
+
+static void
+gltGLDrawBuffer(void *user, GLTbuffer *b, const GLTdrawState *state)
+{
+	(void)user;
+
+	GLboolean isTimed = gltBeginTimer(GLT_TIMER_DRAW);
+	gltGLUseState(state);
+	gltDrawStreamBuffer(b);
+	gltEndTimer(isTimed);
+}
+
+static void
+gltGLUseProgram(void *user, const GLTdrawState *state)
+{
+	(void)user;
+
+	gltGLUseState(state);
+}
+
+GLT_API GLTbackend *
+gltGLBackend(void)
+{
+	static GLTbackend backend = {
+		NULL, gltGLCreateTexture, gltGLUpdateTexture, gltGLGetViewport,
+		gltGLDrawBuffer, gltGLDrawBuffers, gltGLUploadText, gltGLDrawText,
+		gltGLDeleteText, gltGLEndFrame, gltGLDrawLabels, gltGLUseProgram,
+	};
+
+	return &backend;
+}
+
+static GLTnullStats gltNullStats;
+
+static GLuint
+gltNullCreateTexture(void *user, GLsizei width, GLsizei height)
+{
+	(void)width;
+	(void)height;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	return ++stats->textureCount;
+}
+
+static void
+gltNullUpdateTexture(void *user, GLuint texture, GLint x, GLint y,
+	GLsizei width, GLsizei height, GLsizei stride, const unsigned char *pixels)
+{
+	(void)texture;
+	(void)x;
+	(void)y;
+	(void)stride;
+	(void)pixels;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->texelCount += width * height;
+}
+
+static void
+gltNullGetViewport(void *user, GLint *viewport)
+{
+	(void)user;
+
+	for (int i = 0; i < 4; i++) {
+		viewport[i] = 0;
+	}
+}
+
+static void
+gltNullDrawBuffer(void *user, GLTbuffer *b, const GLTdrawState *state)
+{
+	(void)state;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->drawCount++;
+	stats->glyphCount += b->indexCount / 6;
+}
+
+static void
+gltNullDrawBuffers(void *user, const GLTdrawItem *items, GLsizei count,
+	const GLTdrawState *state)
+{
+	(void)state;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->drawCount++;
+	for (GLsizei i = 0; i < count; i++) {
+		stats->glyphCount += items[i].buffer->indexCount / 6;
+	}
+}
+
+static void
+gltNullUploadText(void *user, GLTtext *t, GLsizei first, GLsizei last)
+{
+	(void)t;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->uploadCount += last - first;
+}
+
+static void
+gltNullDrawText(void *user, GLTtext *t, const GLTdrawState *state)
+{
+	(void)state;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->drawCount++;
+	stats->glyphCount += t->length;
+}
+
+static void
+gltNullDeleteText(void *user, GLTtext *t)
+{
+	(void)user;
+	(void)t;
+}
+
+static void
+gltNullDrawLabels(void *user, GLTlabels *l, const GLTlabelState *state)
+{
+	(void)state;
+
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->drawCount++;
+	stats->glyphCount += l->vertexCount / 4;
+}
+
+static void
+gltNullEndFrame(void *user)
+{
+	GLTnullStats *stats = (GLTnullStats *)user;
+	stats->frameCount++;
+}
+
+static void
+gltNullUseProgram(void *user, const GLTdrawState *state)
+{
+	(void)user;
+	(void)state;
+}
+
+GLT_API GLTbackend *
+gltNullBackend(void)
+{
+	static GLTbackend backend = {
+		&gltNullStats, gltNullCreateTexture, gltNullUpdateTexture, gltNullGetViewport,
+		gltNullDrawBuffer, gltNullDrawBuffers, gltNullUploadText, gltNullDrawText,
+		gltNullDeleteText, gltNullEndFrame, gltNullDrawLabels, gltNullUseProgram,
+	};
+
+	return &backend;
+}
+
+GLT_API void
+gltGetNullStats(GLTnullStats *stats)
+{
+	*stats = gltNullStats;
+}
+
+GLT_API void
+gltSetBackend(GLTbackend *backend)
+{
+	GLTbackend *previous = gltCurrentBackend();
+	gltBackend = backend;
+	if (gltCurrentBackend() == previous) {
+		return;
+	}
+
+	/* Texture names of one backend mean nothing to another */
+	GLTcache *cache = &gltGlobalCache;
+	if (cache->textureAtlas && previous == gltGLBackend()) {
+		glDeleteTextures(1, &cache->textureAtlas);
+		gltState.texture = GLT_STATE_UNKNOWN;
+	}
+
+	cache->textureAtlas = 0;
+	if (!cache->pixels) {
+		/* Without a copy of the atlas, the glyphs are rasterized again */
+		for (int font = 0; font < 256; font++) {
+			cache->glyphs[font] = (GLTglyph *)gltRealloc(NULL, cache->glyphs[font],
+				128 * sizeof(GLTglyph), 0);
+		}
+
+		cache->currentOffsetX = 0;
+		cache->currentOffsetY = 0;
+		cache->currentRowHeight = 0;
+	}
+}
+
 #endif /* GLT_IMPL */